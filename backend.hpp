@@ -0,0 +1,295 @@
+#ifndef PURE_CXX_POSIX_BACKEND_HPP
+#define PURE_CXX_POSIX_BACKEND_HPP
+#pragma once
+#if defined(__cplusplus) && (201402L <= __cplusplus)
+
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+
+#include <array>
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+#include <utility>
+#include <stdexcept>
+#include <functional>
+#include <system_error>
+#include <unordered_map>
+
+#include <stdio.h>
+#include <sys/stat.h>
+
+#include "span.hpp"
+#include "retry.hpp"
+#include "config.hpp"
+#include "engine.hpp"
+#include "layout.hpp"
+#include "logger.hpp"
+#include "packer.hpp"
+#include "space.hpp"
+#include "stream.hpp"
+#include "strategy.hpp"
+#include "descriptor.hpp"
+#include "exception.hpp"
+#include "utils.hpp"
+#include "stdfs.hpp"
+
+
+namespace pure_cxx_posix {
+namespace backend {
+
+    // the filesystem as the mover sees it, chosen by the mover's template parameter:
+    //   prepare(config)               checks the route before a batch
+    //   transfer(name, thread, span)  commits one file to the destination and removes the source
+    //   identify(name, identity)      what a failed file is compared with on its next attempt
+    //   quarantine(name, directory)   moves a file aside, false with errno set on failure
+    //   source(name), destination()   for messages
+
+    // directories, replicas and stream sockets of the daemon
+    struct Posix final {
+        inline auto prepare(Config const &config) noexcept(false);
+        inline auto transfer(::std::string const &name, ::std::size_t thread, Span &span) noexcept(false);
+
+        inline auto source(::std::string const &name) const noexcept(false) { return mSource / name; }
+        inline auto const & destination() const noexcept(true) { return mDestination; }
+
+        inline auto identify(::std::string const &name, retry::Identity &identity) const noexcept(false) { return retry::identify(source(name), identity); }
+        inline auto quarantine(::std::string const &name, stdfs::path const &directory) const noexcept(false);
+
+        // a full destination pauses the route, a file that just doesn't fit waits for its retry
+        inline auto exhausted() noexcept(true) { return mRemote || mSpace.exhausted(); }
+
+        // layouts keep their directory handles, the table its measurements, the packer its open segment
+        // and admission the free space of the destination between batches
+        inline explicit Posix(::std::vector<Layout> &layouts, strategy::Table &strategies, Packer &packer, Space &space) noexcept(true)
+            : mLayouts(layouts), mStrategies(strategies), mPacker(packer), mSpace(space) {}
+
+    private:
+        ::std::vector<Layout> &mLayouts;
+        strategy::Table &mStrategies;
+        Packer &mPacker;
+        Space &mSpace;
+        Config const *mConfig = nullptr;
+        stdfs::path mSource, mDestination;
+        bool mRemote = false;
+        engine::Policy mPolicy;
+        ::std::vector<Descriptor> mConnections;
+        ::std::mutex mMutex;
+
+        inline auto send(::std::string const &name, ::std::size_t thread, Span &span) noexcept(false);
+    };
+
+    inline auto Posix::prepare(Config const &config) noexcept(false) {
+        auto const &src = config.src, &dst = config.dst;
+        if (src.empty()) throw PURE_CXX_POSIX_EXCEPTION_MAKE(::std::invalid_argument{"source directory path is empty"});
+        if (dst.empty()) throw PURE_CXX_POSIX_EXCEPTION_MAKE(::std::invalid_argument{"destination directory path is empty"});
+        Logger::instance() << "Moving files from " << src << " to " << dst << "...";
+
+        mConfig = &config;
+        mSource = src;
+        if (! stdfs::exists(mSource)) throw PURE_CXX_POSIX_EXCEPTION_MAKE(::std::invalid_argument{"source directory is not exists"});
+        if (! stdfs::is_directory(mSource)) throw PURE_CXX_POSIX_EXCEPTION_MAKE(::std::invalid_argument{"source is not directory"});
+
+        // one consumer connection per thread, opened on first use and after every broken one;
+        // the batches of a scan share the backend and keep the connections of the previous one
+        auto const remote = stream::remote(dst);
+        auto const destination = remote ? stdfs::path{stream::address(dst)} : stdfs::path{dst};
+        if ((! remote) || (! mRemote) || (destination != mDestination)) mConnections.clear();
+        mRemote = remote;
+        mDestination = destination;
+        mPolicy.cache = static_cast<::std::uint64_t>(config.cache.neutral) << 20;
+        if (mRemote) { mConnections.resize(static_cast<::std::size_t>(config.threads)); return; }
+
+        if (! stdfs::exists(mDestination)) throw PURE_CXX_POSIX_EXCEPTION_MAKE(::std::invalid_argument{"destination directory is not exists"});
+        if (! stdfs::is_directory(mDestination)) throw PURE_CXX_POSIX_EXCEPTION_MAKE(::std::invalid_argument{"destination is not directory"});
+        // replicas share the layout of the destination, every one of them keeps its own handles
+        mLayouts.resize(1 + config.replicas.size());
+        mLayouts.front().prepare(mDestination, config.layout);
+        for (auto index = ::std::size_t{0}; index < config.replicas.size(); ++index) mLayouts[index + 1].prepare(config.replicas[index], config.layout);
+
+        // admission keeps space.low free on the destination, replicas are not measured
+        mSpace.configure(mDestination.native(), static_cast<::std::uint64_t>(config.space.low) << 20);
+        mPolicy.space = &mSpace;
+        mPolicy.method = config.copy.method;
+        mPolicy.table = config.copy.adaptive ? &mStrategies : nullptr;
+        mPolicy.device = mLayouts.front().device();
+        // a new pair of filesystems is measured once before its first files
+        struct ::stat information;
+        if ((! config.copy.adaptive) || (0 != ::stat(mSource.c_str(), &information)) || (! mStrategies.fresh(information.st_dev, mPolicy.device))) return;
+        if (! engine::calibrate(mStrategies, mSource.c_str(), mDestination.c_str(), information.st_dev, mPolicy.device)) {
+            Logger::instance() << "Copy methods from " << mSource << " to " << mDestination << " are measured on the first files";
+            return;
+        }
+        for (auto const &line : mStrategies.describe()) Logger::instance() << "Copy methods by size class for devices " << line;
+    }
+
+    inline auto Posix::send(::std::string const &name, ::std::size_t thread, Span &span) noexcept(false) {
+        auto const src = source(name);
+        auto &connection = mConnections[thread];
+        Logger::instance() << "Sending " << src << " to " << mDestination << "...";
+        span.mark(span::Log);
+        auto &&code = ::std::error_code{};
+        if (! connection) connection = stream::connect(mDestination.native(), code, mConfig->stream.timeout);
+        span.mark(span::Layout);
+        return (! connection) ? engine::Status::failure(code, "connect") : engine::send(src, connection, name, mPolicy, span);
+    }
+
+    inline auto Posix::transfer(::std::string const &name, ::std::size_t thread, Span &span) noexcept(false) {
+        if (mRemote) return send(name, thread, span);
+        if (mPacker.enabled()) {
+            auto packed = false;
+            auto const status = mPacker.append(source(name), name, mPolicy.space, packed, span);
+            if (packed || status.failed()) return status;
+        }
+        auto const slash = name.rfind('/');
+        auto const base = (::std::string::npos == slash) ? name.c_str() : name.c_str() + slash + 1;
+        auto const src = source(name);
+        auto &&code = ::std::error_code{};
+        auto &&subdirectory = ::std::string{};
+        ::std::array<Layout::Handle, engine::replicas> directories;
+        ::std::array<engine::Target, engine::replicas> targets;
+        auto const open = [&] () {
+            auto opened = true;
+            for (auto index = ::std::size_t{0}; opened && (index < mLayouts.size()); ++index) {
+                directories[index] = mLayouts[index].open(subdirectory, code);
+                opened = static_cast<bool>(directories[index]);
+                if (opened) targets[index] = engine::Target{directories[index]->get(), mLayouts[index].device()};
+            }
+            return opened;
+        };
+        auto opened = true;
+        {
+            auto const lock = utils::makeUniqueLock(mMutex); utils::unused(lock);
+            subdirectory = mLayouts.front().subdirectory(name);
+            if (::std::string::npos != slash) subdirectory.append(subdirectory.empty() ? "" : "/").append(name, 0, slash);
+            opened = open();
+        }
+        span.mark(span::Layout);
+        auto const dst = mDestination / subdirectory / base;
+        if (1 < mLayouts.size()) Logger::instance() << "Moving " << src << " to " << dst << " and " << (mLayouts.size() - 1) << " replicas...";
+        else Logger::instance() << "Moving " << src << " to " << dst << "...";
+        span.mark(span::Log);
+        if (! opened) return engine::Status::failure(code, "mkdir");
+        auto const commit = [&] () {
+            if (1 < mLayouts.size()) return engine::replicate(src, targets.data(), mLayouts.size(), base, mPolicy, span);
+            return engine::move(src, directories.front()->get(), base, mPolicy, span);
+        };
+        auto const status = commit();
+        // a cached subdirectory unlinked meanwhile fails the create in it, the only time its handle is checked
+        auto const missing = (::std::generic_category() == status.code.category()) && (ENOENT == status.code.value())
+                          && ((0 == ::std::strcmp("openat", status.operation)) || (0 == ::std::strcmp("linkat", status.operation)));
+        if (! missing) return status;
+        {
+            auto const lock = utils::makeUniqueLock(mMutex); utils::unused(lock);
+            auto stale = false;
+            for (auto &layout : mLayouts) stale = layout.stale(subdirectory) || stale;
+            if (! stale) return status;
+            if (! open()) return engine::Status::failure(code, "mkdir");
+        }
+        return commit();
+    }
+
+    inline auto Posix::quarantine(::std::string const &name, stdfs::path const &directory) const noexcept(false) {
+        auto const target = directory / name;
+        auto &&code = ::std::error_code{};
+        stdfs::create_directories(target.parent_path(), code);
+        return 0 == ::rename(source(name).c_str(), target.c_str());
+    }
+
+    // files are names with sizes in striped hash maps, every transfer costs the injected latency
+    // and fails with the injected probability; it measures the mover without a disk underneath
+    struct Memory final {
+        struct Faults final {
+            double latency = +0.0e+0; // seconds per transfer
+            double rate = +0.0e+0;    // probability of a failed transfer
+            int code = EIO;
+        };
+
+        inline auto add(::std::string const &name, ::std::uint64_t size) noexcept(false) {
+            auto &stripe = mStripes[stripeOf(name)];
+            auto const lock = utils::makeUniqueLock(stripe.mutex); utils::unused(lock);
+            stripe.source[name] = size;
+        }
+
+        inline auto prepare(Config const &) noexcept(true) {}
+        inline auto transfer(::std::string const &name, ::std::size_t thread, Span &span) noexcept(false);
+        inline auto identify(::std::string const &name, retry::Identity &identity) noexcept(false);
+        inline auto quarantine(::std::string const &name, stdfs::path const &) noexcept(false);
+        inline auto exhausted() noexcept(true) { return true; }
+
+        inline auto source(::std::string const &name) const noexcept(false) { return "memory:" + name; }
+        inline auto destination() const noexcept(false) { return ::std::string{"memory"}; }
+
+        // files committed to the destination and moved aside
+        inline auto committed() const noexcept(true) { return mCommitted.load(::std::memory_order_relaxed); }
+        inline auto quarantined() const noexcept(true) { return mQuarantined.load(::std::memory_order_relaxed); }
+
+        inline explicit Memory(Faults const &faults, ::std::size_t threads, ::std::uint32_t seed = 1) noexcept(false) : mFaults{faults} {
+            for (auto index = ::std::size_t{0}; index < threads; ++index) mGenerators.emplace_back(seed + static_cast<::std::uint32_t>(index));
+        }
+
+    private:
+        constexpr static ::std::size_t const stripes = 64;
+
+        struct Stripe final {
+            ::std::mutex mutex;
+            ::std::unordered_map<::std::string, ::std::uint64_t> source, destination;
+        };
+
+        Faults mFaults;
+        ::std::array<Stripe, stripes> mStripes;
+        // one generator per mover thread, a thread only touches its own
+        ::std::vector<::std::minstd_rand> mGenerators;
+        ::std::atomic<::std::size_t> mCommitted{0}, mQuarantined{0};
+
+        inline static ::std::size_t stripeOf(::std::string const &name) noexcept(true) { return ::std::hash<::std::string>{}(name) % stripes; }
+    };
+
+    inline auto Memory::transfer(::std::string const &name, ::std::size_t thread, Span &span) noexcept(false) {
+        span.mark(span::Layout);
+        if (+0.0e+0 < mFaults.latency) ::std::this_thread::sleep_for(::std::chrono::duration<double>{mFaults.latency});
+        span.mark(span::Copy);
+        if (+0.0e+0 < mFaults.rate) {
+            auto &generator = mGenerators[thread];
+            if (::std::uniform_real_distribution<double>{}(generator) < mFaults.rate) return engine::Status::failure(mFaults.code, "write");
+        }
+        auto &stripe = mStripes[stripeOf(name)];
+        auto const lock = utils::makeUniqueLock(stripe.mutex); utils::unused(lock);
+        auto const entry = stripe.source.find(name);
+        if (stripe.source.end() == entry) return engine::Status::failure(ENOENT, "open");
+        stripe.destination[name] = entry->second;
+        stripe.source.erase(entry);
+        mCommitted.fetch_add(1, ::std::memory_order_relaxed);
+        span.mark(span::Commit);
+        return engine::Status::success();
+    }
+
+    inline auto Memory::identify(::std::string const &name, retry::Identity &identity) noexcept(false) {
+        auto &stripe = mStripes[stripeOf(name)];
+        auto const lock = utils::makeUniqueLock(stripe.mutex); utils::unused(lock);
+        auto const entry = stripe.source.find(name);
+        if (stripe.source.end() == entry) return false;
+        identity.inode = ::std::hash<::std::string>{}(name); identity.size = entry->second;
+        return true;
+    }
+
+    inline auto Memory::quarantine(::std::string const &name, stdfs::path const &) noexcept(false) {
+        auto &stripe = mStripes[stripeOf(name)];
+        auto const lock = utils::makeUniqueLock(stripe.mutex); utils::unused(lock);
+        if (0 == stripe.source.erase(name)) { errno = ENOENT; return false; }
+        mQuarantined.fetch_add(1, ::std::memory_order_relaxed);
+        return true;
+    }
+
+} // namespace backend
+} // namespace pure_cxx_posix
+
+#else
+#error "__cplusplus not defined. c++14 or hight is required"
+#endif // defined(__cplusplus) && (201402L <= __cplusplus)
+#endif // PURE_CXX_POSIX_BACKEND_HPP
@@ -0,0 +1,109 @@
+#ifndef PURE_CXX_POSIX_BACKLOG_HPP
+#define PURE_CXX_POSIX_BACKLOG_HPP
+#pragma once
+#if defined(__cplusplus) && (201402L <= __cplusplus)
+
+#include <cstdint>
+#include <cstring>
+
+#include <memory>
+#include <string>
+#include <vector>
+#include <utility>
+#include <stdexcept>
+
+#include "exception.hpp"
+
+
+namespace pure_cxx_posix {
+namespace backlog {
+
+    // a name inside the arena, nul terminated, valid until the backlog is cleared
+    struct Name final {
+        char const *pointer = "";
+        ::std::size_t length = 0;
+
+        inline auto data() const noexcept(true) { return pointer; }
+        inline auto c_str() const noexcept(true) { return pointer; }
+        inline auto size() const noexcept(true) { return length; }
+        inline auto empty() const noexcept(true) { return 0 == length; }
+        inline auto str() const noexcept(false) { return ::std::string{pointer, length}; }
+    };
+
+    // names packed into arena blocks with one 32-bit offset per entry (block index and position),
+    // no allocation per name; blocks are large enough to be mapped and unmapped by malloc on their own,
+    // so clear() gives the memory back to the system
+    struct Type final {
+        constexpr static ::std::size_t const shift = 18;
+        constexpr static ::std::size_t const block = ::std::size_t{1} << shift;
+        constexpr static ::std::size_t const blocks = ::std::size_t{1} << (32 - shift);
+
+        inline auto size() const noexcept(true) { return mOffsets.size(); }
+        inline auto empty() const noexcept(true) { return mOffsets.empty(); }
+
+        inline auto operator [] (::std::size_t index) const noexcept(true) {
+            auto const offset = mOffsets[index];
+            auto const pointer = mBlocks[offset >> shift].get() + (offset & (block - 1));
+            return Name{pointer, ::std::strlen(pointer)};
+        }
+
+        // memory held by the backlog, what the scan cap is compared with
+        inline auto bytes() const noexcept(true) { return mBlocks.size() * block + mOffsets.capacity() * sizeof(::std::uint32_t); }
+
+        inline auto push(char const *name, ::std::size_t length) noexcept(false);
+        template <class T> inline auto push(T const &name) noexcept(false) { return push(name.data(), name.size()); }
+
+        // takes the blocks of other over, names are not copied
+        inline auto append(Type &&other) noexcept(false);
+
+        inline auto clear() noexcept(true) { Blocks{}.swap(mBlocks); Offsets{}.swap(mOffsets); mUsed = block; }
+
+        Type() = default;
+        Type(Type &&) = default;
+        Type & operator = (Type &&) = default;
+        Type(Type const &) = delete;
+        Type & operator = (Type const &) = delete;
+
+    private:
+        using Blocks = ::std::vector<::std::unique_ptr<char[]>>;
+        using Offsets = ::std::vector<::std::uint32_t>;
+
+        Blocks mBlocks;
+        Offsets mOffsets;
+        ::std::size_t mUsed = block;
+    };
+
+    inline auto Type::push(char const *name, ::std::size_t length) noexcept(false) {
+        if (! (length < block)) throw PURE_CXX_POSIX_EXCEPTION_MAKE(::std::length_error{"backlog name is too long"});
+        if (block < mUsed + length + 1) {
+            if (! (mBlocks.size() < blocks)) throw PURE_CXX_POSIX_EXCEPTION_MAKE(::std::length_error{"backlog is full"});
+            mBlocks.emplace_back(new char[block]); mUsed = 0;
+        }
+        auto const pointer = mBlocks.back().get() + mUsed;
+        ::std::memcpy(pointer, name, length); pointer[length] = 0;
+        mOffsets.push_back(static_cast<::std::uint32_t>(((mBlocks.size() - 1) << shift) | mUsed));
+        mUsed += length + 1;
+    }
+
+    inline auto Type::append(Type &&other) noexcept(false) {
+        if (other.empty()) return;
+        if (empty()) { *this = ::std::move(other); return; }
+        if (blocks < mBlocks.size() + other.mBlocks.size()) throw PURE_CXX_POSIX_EXCEPTION_MAKE(::std::length_error{"backlog is full"});
+        auto const base = static_cast<::std::uint32_t>(mBlocks.size() << shift);
+        mOffsets.reserve(mOffsets.size() + other.mOffsets.size());
+        for (auto const offset : other.mOffsets) mOffsets.push_back(base + offset);
+        for (auto &item : other.mBlocks) mBlocks.push_back(::std::move(item));
+        mUsed = other.mUsed;
+        other.clear();
+    }
+
+} // namespace backlog
+
+    using Backlog = backlog::Type;
+
+} // namespace pure_cxx_posix
+
+#else
+#error "__cplusplus not defined. c++14 or hight is required"
+#endif // defined(__cplusplus) && (201402L <= __cplusplus)
+#endif // PURE_CXX_POSIX_BACKLOG_HPP
@@ -0,0 +1,40 @@
+#ifndef PURE_CXX_POSIX_CHECKSUM_HPP
+#define PURE_CXX_POSIX_CHECKSUM_HPP
+#pragma once
+#if defined(__cplusplus) && (201402L <= __cplusplus)
+
+#include <cstdint>
+#include <cstring>
+#include <cstddef>
+
+
+namespace pure_cxx_posix {
+namespace checksum {
+
+    using Value = ::std::uint64_t;
+
+    constexpr static Value const initial = 14695981039346656037ull;
+
+    // fnv-1a over 64 bit words with the byte tail folded in one at a time: not cryptographic,
+    // only meant to catch truncation and corruption between the daemon and its consumers;
+    // when fed in pieces, every piece but the last must be a multiple of 8 bytes
+    inline static auto update(Value value, void const *data, ::std::size_t size) noexcept(true) {
+        constexpr static auto const prime = Value{1099511628211ull};
+        auto const *bytes = static_cast<unsigned char const *>(data);
+        for (; sizeof(Value) <= size; bytes += sizeof(Value), size -= sizeof(Value)) {
+            auto word = Value{}; ::std::memcpy(&word, bytes, sizeof(word));
+            value = (value ^ word) * prime;
+        }
+        for (; 0 < size; ++bytes, --size) value = (value ^ *bytes) * prime;
+        return value;
+    }
+
+    inline static auto make(void const *data, ::std::size_t size) noexcept(true) { return update(initial, data, size); }
+
+} // namespace checksum
+} // namespace pure_cxx_posix
+
+#else
+#error "__cplusplus not defined. c++14 or hight is required"
+#endif // defined(__cplusplus) && (201402L <= __cplusplus)
+#endif // PURE_CXX_POSIX_CHECKSUM_HPP
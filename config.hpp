@@ -0,0 +1,78 @@
+#ifndef PURE_CXX_POSIX_CONFIG_HPP
+#define PURE_CXX_POSIX_CONFIG_HPP
+#pragma once
+#if defined(__cplusplus) && (201402L <= __cplusplus)
+
+#include <memory>
+#include <string>
+#include <vector>
+#include <cstdint>
+
+#include "filter.hpp"
+#include "strategy.hpp"
+
+
+namespace pure_cxx_posix {
+namespace config {
+
+    struct Type final {
+        using Path = ::std::string;
+        using Delay = double;
+
+        Path src = "src", dst = "dst";
+        ::std::vector<Path> replicas;
+        Delay delay = +2.0e+1;
+        bool recursive = false;
+        ::std::int32_t threads = 1;
+
+        struct Poll final { Delay floor = +2.0e+1, ceiling = +2.0e+1; } poll;
+        struct Shard final { ::std::int32_t count = 0; } shard;
+        struct Stream final { Delay timeout = +6.0e+1; } stream;
+        struct Tail final { bool enabled = false; Path state; } tail;
+        struct Span final { ::std::int32_t count = 0; } span;
+        struct Backlog final { ::std::int32_t memory = 64; } backlog;
+        struct Cache final { ::std::int32_t neutral = 128; } cache;
+        // megabytes kept free on the destination, copies that would cut into them pause the route
+        struct Space final { ::std::int32_t low = 0; } space;
+        struct Copy final { bool adaptive = true; strategy::Method method = strategy::Sendfile; } copy;
+        // files of up to size bytes go to segments of the destination, see packer.hpp; 0 is off
+        struct Pack final { ::std::int32_t size = 0, segment = 64; Delay age = +6.0e+1; } pack;
+        struct Retry final { Delay base = +6.0e+1; ::std::int32_t limit = 8; Path quarantine; } retry;
+        struct Storm final { ::std::int32_t threshold = 16; Delay pause = +3.0e+1, interval = +6.0e+1; } storm;
+
+        // patterns as written, compiled once per reload
+        struct Filter final {
+            filter::Patterns include, exclude;
+            ::std::shared_ptr<filter::Type> compiled;
+        } filter;
+
+        // scheduling of one kind of thread, see governor.hpp
+        struct Profile final {
+            ::std::string cpus;
+            ::std::int32_t nice = 0;
+            bool idle = false;
+            ::std::int32_t ioClass = 0, ioLevel = 0;
+            // keys present in the config, the other attributes stay as the thread inherited them
+            struct Given final { bool cpus = false, nice = false, idle = false, io = false; } given;
+        };
+
+        struct Governor final { Profile scan, copy; } governor;
+
+        struct Layout final {
+            enum class Kind { Flat, Hash, Date };
+            Kind kind = Kind::Flat;
+            ::std::int32_t depth = 2;
+            ::std::string format = "%Y/%m/%d";
+        } layout;
+    };
+
+} // namespace config
+
+    using Config = config::Type;
+
+} // namespace pure_cxx_posix
+
+#else
+#error "__cplusplus not defined. c++14 or hight is required"
+#endif // defined(__cplusplus) && (201402L <= __cplusplus)
+#endif // PURE_CXX_POSIX_CONFIG_HPP
@@ -3,25 +3,34 @@
 #pragma once
 #if defined(__cplusplus) && (201402L <= __cplusplus)
 
-#include <mutex>
+#include <atomic>
 #include <string>
-#include <condition_variable>
+#include <cstdint>
 
+#include "rcu.hpp"
+#include "span.hpp"
+#include "config.hpp"
 #include "utils.hpp"
 
 
 namespace pure_cxx_posix {
 namespace context {
 
+    // totals since start for the control socket, queued is what is left of the batch being moved
+    struct Counters final {
+        ::std::atomic<::std::uint64_t> scans{0}, moved{0}, failed{0}, deferred{0};
+        ::std::atomic<::std::size_t> queued{0};
+    };
+
     struct Type final {
         ::std::string name = utils::defaultName();
-        bool condition = true;
-        bool interrupt = false;
-        double delay = +2.0e+1;
-        ::std::string src = "src", dst = "dst";
-
-        ::std::mutex mutex;
-        ::std::condition_variable event;
+        ::std::atomic<bool> condition{true};
+        ::std::atomic<bool> interrupt{false};
+        ::std::atomic<bool> drain{false};
+        ::std::atomic<bool> hold{false};
+        Rcu<Config> config;
+        span::Recorder spans;
+        Counters counters;
 
         inline static auto & instance() noexcept(true) { static Type instance; return instance; }
 
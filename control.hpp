@@ -0,0 +1,290 @@
+#ifndef PURE_CXX_POSIX_CONTROL_HPP
+#define PURE_CXX_POSIX_CONTROL_HPP
+#pragma once
+#if defined(__cplusplus) && (201402L <= __cplusplus)
+
+#include <cerrno>
+#include <cstring>
+
+#include <map>
+#include <array>
+#include <chrono>
+#include <string>
+#include <vector>
+#include <sstream>
+#include <utility>
+#include <algorithm>
+#include <stdexcept>
+#include <functional>
+
+#include <unistd.h>
+#include <sys/un.h>
+#include <sys/stat.h>
+#include <sys/socket.h>
+
+#include "devlog.hpp"
+#include "reactor.hpp"
+#include "context.hpp"
+#include "exception.hpp"
+#include "descriptor.hpp"
+#include "utils.hpp"
+#include "stdfs.hpp"
+
+
+namespace pure_cxx_posix {
+namespace control {
+
+    // next to the pidfile, shards share the name, so each of them gets its own socket by pid
+    inline static ::std::string path(bool sharded) noexcept(false) {
+        auto &&name = utils::copy(Context::instance().name);
+        if (name.empty()) name = utils::defaultName();
+        if (sharded) name += "." + ::std::to_string(::getpid());
+        return stdfs::absolute(name + ".control", "/var/run");
+    }
+
+    // the listening socket, its file is unlinked with it unless a successor has bound its own there meanwhile
+    struct Listener final {
+        inline auto get() const noexcept(true) { return mDescriptor.get(); }
+        inline explicit operator bool () const noexcept(true) { return static_cast<bool>(mDescriptor); }
+
+        Listener() = default;
+        inline explicit Listener(Descriptor &&descriptor, ::std::string path) noexcept(false) : mDescriptor{::std::move(descriptor)}, mPath{::std::move(path)} {
+            struct ::stat information;
+            if (0 != ::stat(mPath.c_str(), &information)) { mPath.clear(); return; }
+            mDevice = information.st_dev; mInode = information.st_ino;
+        }
+        inline Listener(Listener &&other) noexcept(true)
+            : mDescriptor{::std::move(other.mDescriptor)}, mPath{::std::move(other.mPath)}, mDevice{other.mDevice}, mInode{other.mInode} { other.mPath.clear(); }
+        inline ~Listener() noexcept(true) {
+            struct ::stat information;
+            if ((! mPath.empty()) && (0 == ::stat(mPath.c_str(), &information)) && (mDevice == information.st_dev) && (mInode == information.st_ino)) ::unlink(mPath.c_str());
+        }
+
+        Listener(Listener const &) = delete;
+        template <class T> Listener & operator = (T &&) = delete;
+
+    private:
+        Descriptor mDescriptor;
+        ::std::string mPath;
+        ::dev_t mDevice = 0;
+        ::ino_t mInode = 0;
+    };
+
+    // nonblocking listener for the reactor, only the owner of the daemon may connect: the socket
+    // is created with its final mode, there is no window between bind() and chmod()
+    inline static auto listen(bool sharded) noexcept(false) {
+        auto const &&path = control::path(sharded);
+        auto address = ::sockaddr_un{}; address.sun_family = AF_UNIX;
+        if (! (path.size() < sizeof(address.sun_path))) throw PURE_CXX_POSIX_EXCEPTION_MAKE(::std::invalid_argument{"control socket path is too long"});
+        ::std::memcpy(address.sun_path, path.c_str(), path.size() + 1);
+        auto &&descriptor = Descriptor{::socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0)};
+        if (! descriptor) throw PURE_CXX_POSIX_EXCEPTION_MAKE(::std::runtime_error{"control socket() failure: " + utils::errorCodeToString()});
+        ::unlink(path.c_str());
+        auto const mask = ::umask(077);
+        auto const bound = ::bind(descriptor.get(), reinterpret_cast<::sockaddr const *>(&address), sizeof(address));
+        auto const code = errno;
+        ::umask(mask);
+        if (0 != bound) throw PURE_CXX_POSIX_EXCEPTION_MAKE(::std::runtime_error{"control bind() failure: " + utils::errorCodeToString(code)});
+        auto &&listener = Listener{::std::move(descriptor), path};
+        if (0 != ::listen(listener.get(), 8)) throw PURE_CXX_POSIX_EXCEPTION_MAKE(::std::runtime_error{"control listen() failure: " + utils::errorCodeToString()});
+        return ::std::move(listener);
+    }
+
+    // seconds a client gets for the whole exchange, bytes of its command line
+    constexpr static ::time_t const patience = 1;
+    constexpr static ::std::size_t const limit = 1024;
+
+    // one command line per connection and its answer; the connection is nonblocking and edge-triggered
+    // in the reactor, a client that is slow to send or to read never holds the reactor thread
+    struct Session final {
+        using Clock = ::std::chrono::steady_clock;
+
+        enum class Step { Wait, Line, Close };
+
+        Descriptor connection;
+        ::std::string input, output;
+        bool answered = false;
+        Clock::time_point deadline = Clock::now() + ::std::chrono::seconds{patience};
+
+        // reads what arrived, Line once input holds the whole command line
+        inline auto read() noexcept(false) {
+            ::std::array<char, 256> buffer;
+            while (input.size() < limit) {
+                auto const count = ::recv(connection.get(), buffer.data(), buffer.size(), 0);
+                if ((0 > count) && (EINTR == errno)) continue;
+                if ((0 > count) && ((EAGAIN == errno) || (EWOULDBLOCK == errno))) return Step::Wait;
+                if (0 >= count) break;
+                input.append(buffer.data(), static_cast<::std::size_t>(count));
+                if (::std::string::npos != input.find('\n')) break;
+            }
+            auto const end = input.find_first_of("\r\n");
+            if (::std::string::npos != end) input.resize(end);
+            return input.empty() ? Step::Close : Step::Line;
+        }
+
+        // sends what the socket takes, true while some of the output is left
+        inline auto write() noexcept(true) {
+            while (! output.empty()) {
+                auto const count = ::send(connection.get(), output.data(), output.size(), MSG_NOSIGNAL);
+                if ((0 > count) && (EINTR == errno)) continue;
+                if ((0 > count) && ((EAGAIN == errno) || (EWOULDBLOCK == errno))) return true;
+                // best effort, a client that went away doesn't concern the daemon
+                if (0 > count) return false;
+                output.erase(0, static_cast<::std::size_t>(count));
+            }
+            return false;
+        }
+    };
+
+    // the next pending connection, an empty descriptor when there is none
+    inline static auto accept(Listener const &listener) noexcept(true) {
+        return Descriptor{::accept4(listener.get(), nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC)};
+    }
+
+    // what the daemon tells about itself for stats, the totals come from the context and the log sink
+    struct Stats final {
+        char const *state = "idle";
+        double interval = +0.0e+0;
+        ::std::size_t queued = 0, retrying = 0, streak = 0, threads = 0;
+        ::std::uint64_t free = 0;
+        // fastest copy method per size class (64K, 1M, 16M, 256M, larger) of every pair of devices seen
+        ::std::vector<::std::string> copies;
+    };
+
+    enum class Scan { Started, Queued, Paused };
+
+    // the daemon side of the commands: adjust gets interval or set and the rest of the line,
+    // it throws what is wrong with them
+    struct Commands final {
+        ::std::function<Scan()> scan;
+        ::std::function<void()> pause, resume;
+        ::std::function<void(::std::string const &, ::std::string const &)> adjust;
+        ::std::function<Stats()> stats;
+    };
+
+    // answers a command line with "ok" or "error" and a reason on the first line
+    inline static auto execute(::std::string const &line, Commands const &commands) noexcept(false) {
+        auto stream = ::std::istringstream{line};
+        auto &&name = ::std::string{}; stream >> name;
+        if ("scan" == name) {
+            auto const scan = commands.scan();
+            if (Scan::Paused == scan) return ::std::string{"error paused\n"};
+            return ::std::string{(Scan::Queued == scan) ? "ok after the running scan\n" : "ok\n"};
+        }
+        if ("pause" == name) { commands.pause(); return ::std::string{"ok\n"}; }
+        if ("resume" == name) { commands.resume(); return ::std::string{"ok\n"}; }
+        if (("interval" == name) || ("set" == name)) {
+            auto &&rest = ::std::string{}; ::std::getline(stream >> ::std::ws, rest);
+            commands.adjust(name, rest);
+            return ::std::string{"ok\n"};
+        }
+        if ("stats" == name) {
+            auto const stats = commands.stats();
+            auto const &counters = Context::instance().counters;
+            auto const &log = devlog::instance().statistics;
+            auto &&result = ::std::ostringstream{};
+            result << "ok\n"
+                   << "state " << stats.state << "\n"
+                   << "interval " << stats.interval << "\n"
+                   << "queued " << stats.queued << "\n"
+                   << "scans " << counters.scans.load(::std::memory_order_relaxed) << "\n"
+                   << "moved " << counters.moved.load(::std::memory_order_relaxed) << "\n"
+                   << "failed " << counters.failed.load(::std::memory_order_relaxed) << "\n"
+                   << "deferred " << counters.deferred.load(::std::memory_order_relaxed) << "\n"
+                   << "retrying " << stats.retrying << "\n"
+                   << "streak " << stats.streak << "\n"
+                   << "threads " << stats.threads << "\n"
+                   << "free " << stats.free << "\n"
+                   << "log.sent " << log.sent.load(::std::memory_order_relaxed) << "\n"
+                   << "log.dropped " << log.dropped.load(::std::memory_order_relaxed) << "\n"
+                   << "log.reconnects " << log.reconnects.load(::std::memory_order_relaxed) << "\n";
+            for (auto const &copy : stats.copies) result << "copy " << copy << "\n";
+            return result.str();
+        }
+        return ::std::string{"error unknown command, expected scan, pause, resume, interval <seconds>, set <key> <value> or stats\n"};
+    }
+
+    // the listener and its sessions in a reactor: a handful of clients at a time, each gets patience for its exchange
+    struct Server final {
+        constexpr static ::std::size_t const capacity = 16;
+
+        inline explicit Server(Reactor &reactor, Listener &&listener, Commands &&commands) noexcept(false);
+
+        Server(Server &&) = delete;
+        Server(Server const &) = delete;
+        template <class T> Server & operator = (T &&) = delete;
+
+    private:
+        Reactor &mReactor;
+        Listener mListener;
+        Commands mCommands;
+        ::std::map<int, Session> mSessions;
+        Descriptor mExpiry;
+
+        inline auto admit() noexcept(false) -> void;
+        inline auto converse(int descriptor) noexcept(false) -> void;
+        inline auto hangup(int descriptor) noexcept(false) -> void;
+        inline auto expire() noexcept(false) -> void;
+    };
+
+    inline Server::Server(Reactor &reactor, Listener &&listener, Commands &&commands) noexcept(false)
+        : mReactor{reactor}, mListener{::std::move(listener)}, mCommands{::std::move(commands)}, mExpiry{reactor::timer::make()} {
+        if (! mListener) return;
+        mReactor.add(mListener.get(), EPOLLIN, [this] (auto) { admit(); });
+        mReactor.add(mExpiry.get(), EPOLLIN, [this] (auto) { expire(); });
+    }
+
+    inline auto Server::admit() noexcept(false) -> void {
+        for (auto &&connection = accept(mListener); connection; connection = accept(mListener)) {
+            if (! (mSessions.size() < capacity)) continue;
+            auto const descriptor = connection.get();
+            auto &session = mSessions[descriptor];
+            session.connection = ::std::move(connection);
+            try { mReactor.add(descriptor, EPOLLIN | EPOLLOUT | EPOLLET, [this, descriptor] (auto) { converse(descriptor); }); }
+            catch(...) { mSessions.erase(descriptor); continue; }
+            if (1 == mSessions.size()) reactor::timer::arm(mExpiry, patience);
+        }
+    }
+
+    inline auto Server::converse(int descriptor) noexcept(false) -> void {
+        auto const iterator = mSessions.find(descriptor);
+        if (mSessions.end() == iterator) return;
+        auto &session = iterator->second;
+        if (! session.answered) {
+            auto const step = session.read();
+            if (Session::Step::Wait == step) return;
+            if (Session::Step::Close == step) return hangup(descriptor);
+            try { session.output = execute(session.input, mCommands); }
+            catch (::std::exception const &error) { session.output = "error " + ::std::string{error.what()} + "\n"; }
+            catch(...) { session.output = "error unknown failure\n"; }
+            session.answered = true;
+        }
+        if (! session.write()) hangup(descriptor);
+    }
+
+    inline auto Server::hangup(int descriptor) noexcept(false) -> void {
+        mReactor.remove(descriptor); mSessions.erase(descriptor);
+        if (mSessions.empty()) reactor::timer::arm(mExpiry, +0.0e+0);
+    }
+
+    inline auto Server::expire() noexcept(false) -> void {
+        if (0 == reactor::timer::read(mExpiry)) return;
+        auto const now = Session::Clock::now();
+        auto next = now + ::std::chrono::seconds{patience};
+        for (auto iterator = mSessions.begin(); mSessions.end() != iterator;) {
+            auto const descriptor = iterator->first;
+            auto const expired = iterator->second.deadline <= now;
+            if (! expired) next = ::std::min(next, iterator->second.deadline);
+            ++iterator;
+            if (expired) hangup(descriptor);
+        }
+        if (! mSessions.empty()) reactor::timer::arm(mExpiry, ::std::chrono::duration<double>{next - now}.count());
+    }
+
+} // namespace control
+} // namespace pure_cxx_posix
+
+#else
+#error "__cplusplus not defined. c++14 or hight is required"
+#endif // defined(__cplusplus) && (201402L <= __cplusplus)
+#endif // PURE_CXX_POSIX_CONTROL_HPP
@@ -0,0 +1,46 @@
+#ifndef PURE_CXX_POSIX_DESCRIPTOR_HPP
+#define PURE_CXX_POSIX_DESCRIPTOR_HPP
+#pragma once
+#if defined(__cplusplus) && (201402L <= __cplusplus)
+
+#include <utility>
+
+#include <unistd.h>
+
+
+namespace pure_cxx_posix {
+namespace descriptor {
+
+    struct Type final {
+        using Value = int;
+
+        inline auto get() const noexcept(true) { return mValue; }
+        inline explicit operator bool () const noexcept(true) { return 0 <= mValue; }
+
+        inline auto release() noexcept(true) { auto const value = mValue; mValue = -1; return value; }
+        inline auto reset(Value value = -1) noexcept(true) { if (0 <= mValue) ::close(mValue); mValue = value; }
+
+        inline Type & operator = (Type &&other) noexcept(true) { if (this != &other) reset(other.release()); return *this; }
+        Type & operator = (Type const &) = delete;
+
+        Type() = default;
+        inline explicit Type(Value value) noexcept(true) : mValue{value} {}
+        inline Type(Type &&other) noexcept(true) : mValue{other.release()} {}
+        Type(Type const &) = delete;
+
+        inline ~Type() noexcept(true) { reset(); }
+
+    private:
+        Value mValue = -1;
+    };
+
+} // namespace descriptor
+
+    using Descriptor = descriptor::Type;
+
+} // namespace pure_cxx_posix
+
+#else
+#error "__cplusplus not defined. c++14 or hight is required"
+#endif // defined(__cplusplus) && (201402L <= __cplusplus)
+#endif // PURE_CXX_POSIX_DESCRIPTOR_HPP
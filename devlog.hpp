@@ -0,0 +1,208 @@
+#ifndef PURE_CXX_POSIX_DEVLOG_HPP
+#define PURE_CXX_POSIX_DEVLOG_HPP
+#pragma once
+#if defined(__cplusplus) && (201402L <= __cplusplus)
+
+#include <ctime>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+
+#include <array>
+#include <deque>
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+#include <utility>
+#include <condition_variable>
+
+#include <poll.h>
+#include <signal.h>
+#include <syslog.h>
+#include <unistd.h>
+#include <sys/un.h>
+#include <sys/uio.h>
+#include <sys/socket.h>
+
+#include "logger.hpp"
+#include "context.hpp"
+#include "descriptor.hpp"
+#include "utils.hpp"
+
+
+namespace pure_cxx_posix {
+namespace devlog {
+
+    // totals since start, shown by the stats command of the control socket
+    struct Statistics final {
+        ::std::atomic<::std::uint64_t> sent{0}, dropped{0}, reconnects{0};
+    };
+
+    // rfc 3164 datagrams written straight to /dev/log: headers are rendered once per second,
+    // records are queued by the caller and sent in sendmmsg batches from a writer thread
+    struct Type final {
+        Statistics statistics;
+
+        inline auto sink(int priority, char const *prefix) noexcept(false);
+        inline auto push(int priority, char const *prefix, ::std::string const &message) noexcept(true);
+
+        inline static auto & instance() noexcept(true) { static Type instance; return instance; }
+
+    private:
+        using Record = ::std::string;
+
+        constexpr static ::std::size_t const capacity = 4096;
+        constexpr static ::std::size_t const batch = 64;
+
+        ::std::mutex mMutex;
+        ::std::condition_variable mEvent;
+        ::std::deque<Record> mQueue;
+        bool mCondition = true;
+        ::std::uint64_t mUnreported = 0;
+
+        ::std::time_t mSecond = -1;
+        ::std::array<char, 32> mTimestamp{};
+        ::std::string mTag;
+
+        Descriptor mSocket;
+        ::std::thread mWriter;
+
+        inline auto render(int priority, char const *prefix, ::std::string const &message) noexcept(false);
+        inline auto connect() noexcept(true);
+        inline auto send(::std::vector<Record> &records) noexcept(true);
+        inline auto run() noexcept(true);
+
+        inline Type() noexcept(false);
+        inline ~Type() noexcept(true);
+
+        template <class ... T> Type(T && ...) = delete;
+        template <class T> Type & operator = (T &&) = delete;
+    };
+
+    inline auto Type::render(int priority, char const *prefix, ::std::string const &message) noexcept(false) {
+        auto const now = ::std::time(nullptr);
+        if (now != mSecond) {
+            auto time = ::tm{}; ::localtime_r(&now, &time);
+            if (0 == ::std::strftime(mTimestamp.data(), mTimestamp.size(), "%b %e %T", &time)) mTimestamp[0] = 0;
+            mSecond = now;
+        }
+        auto &&record = Record{};
+        record.reserve(8 + 15 + mTag.size() + ::std::strlen(prefix) + message.size());
+        record.append("<").append(::std::to_string(LOG_USER | priority)).append(">").append(mTimestamp.data()).append(mTag).append(prefix).append(message);
+        return ::std::move(record);
+    }
+
+    inline auto Type::push(int priority, char const *prefix, ::std::string const &message) noexcept(true) {
+        try {
+            auto lock = utils::makeUniqueLock(mMutex);
+            if (! (mQueue.size() < capacity)) { ++mUnreported; statistics.dropped.fetch_add(1, ::std::memory_order_relaxed); return; }
+            mQueue.push_back(render(priority, prefix, message));
+            lock.unlock();
+            mEvent.notify_one();
+        } catch(...) { statistics.dropped.fetch_add(1, ::std::memory_order_relaxed); }
+    }
+
+    inline auto Type::sink(int priority, char const *prefix) noexcept(false) {
+        return [this, priority, prefix] (auto &&message) { push(priority, prefix, message); };
+    }
+
+    inline auto Type::connect() noexcept(true) {
+        auto address = ::sockaddr_un{}; address.sun_family = AF_UNIX;
+        ::std::strncpy(address.sun_path, _PATH_LOG, sizeof(address.sun_path) - 1);
+        mSocket = Descriptor{::socket(AF_UNIX, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0)};
+        if (! mSocket) return false;
+        if (0 == ::connect(mSocket.get(), reinterpret_cast<::sockaddr const *>(&address), sizeof(address))) return true;
+        mSocket.reset();
+        return false;
+    }
+
+    // returns how many records are left unsent because the socket is unusable, oversized ones are dropped on the way
+    inline auto Type::send(::std::vector<Record> &records) noexcept(true) {
+        ::std::array<::iovec, batch> vectors;
+        ::std::array<::mmsghdr, batch> messages;
+        auto offset = ::std::size_t{0}, attempts = ::std::size_t{0};
+        while (offset < records.size()) {
+            if ((! mSocket) && (! connect())) break;
+            auto const count = (records.size() - offset < batch) ? records.size() - offset : batch;
+            for (auto index = ::std::size_t{0}; index < count; ++index) {
+                auto &record = records[offset + index];
+                vectors[index] = ::iovec{&record[0], record.size()};
+                messages[index] = ::mmsghdr{};
+                messages[index].msg_hdr.msg_iov = &vectors[index];
+                messages[index].msg_hdr.msg_iovlen = 1;
+            }
+            auto const sent = ::sendmmsg(mSocket.get(), messages.data(), static_cast<unsigned int>(count), MSG_NOSIGNAL);
+            if (0 < sent) { offset += static_cast<::std::size_t>(sent); attempts = 0; statistics.sent.fetch_add(static_cast<::std::uint64_t>(sent), ::std::memory_order_relaxed); continue; }
+            // a record too long for a datagram fails alone, the ones after it still go out
+            if (EMSGSIZE == errno) {
+                ++offset; attempts = 0;
+                statistics.dropped.fetch_add(1, ::std::memory_order_relaxed);
+                auto const lock = utils::makeUniqueLock(mMutex); utils::unused(lock);
+                ++mUnreported;
+                continue;
+            }
+            if (! (++attempts < 3)) break;
+            if ((EAGAIN == errno) || (EWOULDBLOCK == errno) || (ENOBUFS == errno)) {
+                auto descriptor = ::pollfd{mSocket.get(), POLLOUT, 0};
+                ::poll(&descriptor, 1, 100);
+                continue;
+            }
+            if (EINTR == errno) continue;
+            mSocket.reset();
+            statistics.reconnects.fetch_add(1, ::std::memory_order_relaxed);
+        }
+        return records.size() - offset;
+    }
+
+    inline auto Type::run() noexcept(true) {
+        ::std::vector<Record> records; records.reserve(batch);
+        while (true) {
+            auto lock = utils::makeUniqueLock(mMutex);
+            mEvent.wait(lock, [this] () { return (! mQueue.empty()) || (! mCondition); });
+            if (mQueue.empty()) break;
+            records.clear();
+            if (0 < mUnreported) try {
+                records.push_back(render(LOG_ERR, "[ERROR] ", ::std::to_string(mUnreported) + " log messages dropped"));
+                mUnreported = 0;
+            } catch(...) {}
+            while ((! mQueue.empty()) && (records.size() < batch)) { records.push_back(::std::move(mQueue.front())); mQueue.pop_front(); }
+            lock.unlock();
+            auto const unsent = send(records);
+            if (0 == unsent) continue;
+            statistics.dropped.fetch_add(unsent, ::std::memory_order_relaxed);
+            lock.lock(); mUnreported += unsent; lock.unlock();
+            ::std::this_thread::sleep_for(::std::chrono::milliseconds{100});
+        }
+    }
+
+    inline Type::Type() noexcept(false) :
+        mTag{" " + (Context::instance().name.empty() ? ::std::string{utils::defaultName()} : Context::instance().name) + "[" + ::std::to_string(::getpid()) + "]: "}
+    {
+        // the writer must never take a process directed signal, everything is handled through signalfd
+        ::sigset_t all, original; ::sigfillset(&all);
+        ::pthread_sigmask(SIG_SETMASK, &all, &original);
+        try { mWriter = ::std::thread{[this] () { run(); }}; } catch(...) { ::pthread_sigmask(SIG_SETMASK, &original, nullptr); throw; }
+        ::pthread_sigmask(SIG_SETMASK, &original, nullptr);
+    }
+
+    inline Type::~Type() noexcept(true) {
+        { auto const lock = utils::makeUniqueLock(mMutex); utils::unused(lock); mCondition = false; }
+        mEvent.notify_all();
+        if (mWriter.joinable()) mWriter.join();
+    }
+
+    inline static auto & instance() noexcept(true) { return Type::instance(); }
+
+} // namespace devlog
+
+    using Devlog = devlog::Type;
+
+} // namespace pure_cxx_posix
+
+#else
+#error "__cplusplus not defined. c++14 or hight is required"
+#endif // defined(__cplusplus) && (201402L <= __cplusplus)
+#endif // PURE_CXX_POSIX_DEVLOG_HPP
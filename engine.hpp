@@ -0,0 +1,454 @@
+#ifndef PURE_CXX_POSIX_ENGINE_HPP
+#define PURE_CXX_POSIX_ENGINE_HPP
+#pragma once
+#if defined(__cplusplus) && (201402L <= __cplusplus)
+
+#include <cerrno>
+
+#include <array>
+#include <chrono>
+#include <utility>
+#include <algorithm>
+#include <system_error>
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/ioctl.h>
+#include <sys/sendfile.h>
+#include <linux/fs.h>
+
+#include "span.hpp"
+#include "probe.hpp"
+#include "space.hpp"
+#include "strategy.hpp"
+#include "stream.hpp"
+#include "checksum.hpp"
+#include "descriptor.hpp"
+#include "stdfs.hpp"
+
+
+namespace pure_cxx_posix {
+namespace engine {
+
+    // per-file outcome of the move engine, expected failures never leave it as exceptions
+    struct Status final {
+        ::std::error_code code;
+        char const *operation = "";
+
+        inline auto failed() const noexcept(true) { return static_cast<bool>(code); }
+        // the destination has no room for the file, a matter of the route and not of the file
+        inline auto full() const noexcept(true) { return (::std::generic_category() == code.category()) && ((ENOSPC == code.value()) || (EDQUOT == code.value())); }
+
+        inline static auto success() noexcept(true) { return Status{}; }
+        inline static auto failure(::std::error_code code, char const *operation) noexcept(true) { return Status{::std::move(code), operation}; }
+        inline static auto failure(int code, char const *operation) noexcept(true) { return failure(::std::error_code{code, ::std::generic_category()}, operation); }
+    };
+
+    // copies the rest of in to out with the method asked for, a method the kernel doesn't support for
+    // the pair of files falls back to the next simpler one: range to sendfile, sendfile to buffer;
+    // method ends up as the one that finished the copy
+    inline static auto copy(int in, int out, strategy::Method &method) noexcept(true) {
+        if (strategy::Range == method) while (true) {
+            auto const count = ::copy_file_range(in, nullptr, out, nullptr, 0x40000000, 0);
+            if (0 < count) continue;
+            if (0 == count) return Status::success();
+            if (EINTR == errno) continue;
+            if ((EXDEV == errno) || (EINVAL == errno) || (ENOSYS == errno) || (EOPNOTSUPP == errno)) { method = strategy::Sendfile; break; }
+            return Status::failure(errno, "copy_file_range");
+        }
+        if (strategy::Sendfile == method) while (true) {
+            auto const count = ::sendfile(out, in, nullptr, 0x40000000);
+            if (0 < count) continue;
+            if (0 == count) return Status::success();
+            if (EINTR == errno) continue;
+            if ((EINVAL == errno) || (ENOSYS == errno)) { method = strategy::Buffer; break; }
+            return Status::failure(errno, "sendfile");
+        }
+        ::std::array<char, 0x10000> buffer;
+        while (true) {
+            auto const count = ::read(in, buffer.data(), buffer.size());
+            if (0 == count) return Status::success();
+            if (0 > count) { if (EINTR == errno) continue; return Status::failure(errno, "read"); }
+            for (auto offset = ::ssize_t{0}; offset < count;) {
+                auto const written = ::write(out, buffer.data() + offset, static_cast<::std::size_t>(count - offset));
+                if (0 > written) { if (EINTR == errno) continue; return Status::failure(errno, "write"); }
+                offset += written;
+            }
+        }
+    }
+
+    // sendfile while the kernel supports the pair of files, plain read/write otherwise
+    inline static auto copy(int in, int out) noexcept(true) {
+        auto method = strategy::Sendfile;
+        return copy(in, out, method);
+    }
+
+    // what the engine may choose per file
+    struct Policy final {
+        ::std::uint64_t cache = 0; // files of at least this size are copied without keeping them in the page cache, 0 never
+        strategy::Method method = strategy::Sendfile;
+        strategy::Table *table = nullptr; // chooses the method per file when set
+        ::std::uint64_t device = 0; // of the destination
+        space::Type *space = nullptr; // admits copies against the free space of the destination when set
+
+        inline auto neutral(::std::uint64_t size) const noexcept(true) { return (0 < cache) && (cache <= size); }
+    };
+
+namespace eviction {
+
+    constexpr static ::off_t const chunk = 0x800000;
+
+    // [offset, offset + length) was copied from in to out: the read pages are dropped at once, the written
+    // ones are pushed to writeback and dropped one chunk later, when their writeback had time to complete
+    inline static auto copied(int in, int out, ::off_t offset, ::off_t length) noexcept(true) {
+        ::posix_fadvise(in, offset, length, POSIX_FADV_DONTNEED);
+        ::sync_file_range(out, offset, length, SYNC_FILE_RANGE_WRITE);
+        if (offset < chunk) return;
+        ::sync_file_range(out, offset - chunk, chunk, SYNC_FILE_RANGE_WAIT_BEFORE | SYNC_FILE_RANGE_WRITE | SYNC_FILE_RANGE_WAIT_AFTER);
+        ::posix_fadvise(out, offset - chunk, chunk, POSIX_FADV_DONTNEED);
+    }
+
+    inline static auto finished(int out) noexcept(true) {
+        ::sync_file_range(out, 0, 0, SYNC_FILE_RANGE_WAIT_BEFORE | SYNC_FILE_RANGE_WRITE | SYNC_FILE_RANGE_WAIT_AFTER);
+        ::posix_fadvise(out, 0, 0, POSIX_FADV_DONTNEED);
+    }
+
+} // namespace eviction
+
+    // cache neutral copy of a large file in chunks, writeback of a chunk overlaps with copying the next one
+    inline static auto spill(int in, int out) noexcept(true) {
+        ::posix_fadvise(in, 0, 0, POSIX_FADV_SEQUENTIAL);
+        auto sendfile = true;
+        ::std::array<char, 0x10000> buffer;
+        // copies up to length bytes at offset, returns how many or -errno
+        auto const transfer = [in, out, &sendfile, &buffer] (::off_t offset, ::off_t length) -> ::off_t {
+            auto done = ::off_t{0};
+            while (done < length) {
+                auto position = offset + done;
+                auto const count = sendfile ? ::sendfile(out, in, &position, static_cast<::std::size_t>(length - done)) : ::pread(in, buffer.data(), static_cast<::std::size_t>(::std::min<::off_t>(length - done, static_cast<::off_t>(buffer.size()))), position);
+                if (0 == count) break;
+                if (0 > count) {
+                    if (EINTR == errno) continue;
+                    if (sendfile && ((EINVAL == errno) || (ENOSYS == errno))) { sendfile = false; continue; }
+                    return -errno;
+                }
+                if (! sendfile) for (auto written = ::ssize_t{0}; written < count;) {
+                    auto const result = ::pwrite(out, buffer.data() + written, static_cast<::std::size_t>(count - written), position + written);
+                    if (0 > result) { if (EINTR == errno) continue; return -errno; }
+                    written += result;
+                }
+                done += count;
+            }
+            return done;
+        };
+        for (auto offset = ::off_t{0};;) {
+            auto const count = transfer(offset, eviction::chunk);
+            if (0 > count) return Status::failure(static_cast<int>(-count), sendfile ? "sendfile" : "write");
+            if (0 == count) break;
+            eviction::copied(in, out, offset, count);
+            offset += count;
+            if (count < eviction::chunk) break;
+        }
+        eviction::finished(out);
+        return Status::success();
+    }
+
+    // files of at least this size get their blocks before the copy
+    constexpr static ::std::uint64_t const preallocation = 0x10000;
+
+    // allocates size bytes of out up front, so a full destination fails here and not in the middle of the copy,
+    // and the extents come out contiguous; the size of out is left alone, a shrinking source leaves no zeros behind;
+    // filesystems without fallocate are copied to as before
+    inline static auto preallocate(int out, ::std::uint64_t size) noexcept(true) {
+        if ((size < preallocation) || (0 == ::fallocate(out, FALLOC_FL_KEEP_SIZE, 0, static_cast<::off_t>(size)))) return true;
+        return (ENOSPC != errno) && (EDQUOT != errno);
+    }
+
+    // blocks preallocated past what was copied, when the source shrank meanwhile, are given back before the close
+    inline static auto trim(int out, ::std::uint64_t size) noexcept(true) {
+        if (size < preallocation) return true;
+        struct ::stat information;
+        return (0 == ::fstat(out, &information)) && (0 == ::ftruncate(out, information.st_size));
+    }
+
+    // copies [from, to) of in to the same offsets of out, copy_file_range when the filesystems allow it
+    inline static auto append(int in, int out, ::off_t from, ::off_t to) noexcept(true) {
+        auto source = from, target = from;
+        while (source < to) {
+            auto const count = ::copy_file_range(in, &source, out, &target, static_cast<::std::size_t>(to - source), 0);
+            if (0 < count) continue;
+            if (0 == count) return Status::failure(ENODATA, "copy_file_range");
+            if (EINTR == errno) continue;
+            if ((EXDEV == errno) || (EINVAL == errno) || (ENOSYS == errno) || (EOPNOTSUPP == errno)) break;
+            return Status::failure(errno, "copy_file_range");
+        }
+        ::std::array<char, 0x10000> buffer;
+        while (source < to) {
+            auto const wanted = static_cast<::std::size_t>(::std::min<::off_t>(to - source, static_cast<::off_t>(buffer.size())));
+            auto const count = ::pread(in, buffer.data(), wanted, source);
+            if (0 == count) return Status::failure(ENODATA, "pread");
+            if (0 > count) { if (EINTR == errno) continue; return Status::failure(errno, "pread"); }
+            for (auto offset = ::ssize_t{0}; offset < count;) {
+                auto const written = ::pwrite(out, buffer.data() + offset, static_cast<::std::size_t>(count - offset), target);
+                if (0 > written) { if (EINTR == errno) continue; return Status::failure(errno, "pwrite"); }
+                offset += written; target += written;
+            }
+            source += count;
+        }
+        return Status::success();
+    }
+
+    // copies src into an already opened destination directory and unlinks it,
+    // every stage ends with a probe and a mark of the span
+    inline static auto move(stdfs::path const &src, int directory, char const *name, Policy const &policy, Span &span) noexcept(true) {
+        PURE_CXX_POSIX_PROBE(move__start, name, src.c_str(), directory);
+        auto in = Descriptor{::open(src.c_str(), O_RDONLY | O_CLOEXEC)};
+        if (! in) return Status::failure(errno, "open");
+        struct ::stat information;
+        if (0 != ::fstat(in.get(), &information)) return Status::failure(errno, "fstat");
+        if (! S_ISREG(information.st_mode)) return Status::failure(EINVAL, "open");
+        auto const size = static_cast<::std::uint64_t>(information.st_size);
+        space::Reservation reservation{policy.space, size};
+        if (! reservation.admitted()) return Status::failure(ENOSPC, "admit");
+        auto out = Descriptor{::openat(directory, name, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, information.st_mode & 07777)};
+        if (! out) return Status::failure(errno, "openat");
+        if (! preallocate(out.get(), size)) { auto const code = errno; ::unlinkat(directory, name, 0); return Status::failure(code, "fallocate"); }
+        PURE_CXX_POSIX_PROBE(open__done, name, information.st_size);
+        span.mark(span::Open);
+        auto const adaptive = (nullptr != policy.table) && (! policy.neutral(size));
+        auto const chosen = adaptive ? policy.table->choose(information.st_dev, policy.device, size) : policy.method;
+        auto method = chosen;
+        auto const start = ::std::chrono::steady_clock::now();
+        auto const status = policy.neutral(size) ? engine::spill(in.get(), out.get()) : engine::copy(in.get(), out.get(), method);
+        if (status.failed()) { ::unlinkat(directory, name, 0); return status; }
+        if (adaptive) try {
+            auto const elapsed = ::std::chrono::duration_cast<::std::chrono::nanoseconds>(::std::chrono::steady_clock::now() - start).count();
+            policy.table->record(information.st_dev, policy.device, size, chosen, method, static_cast<::std::uint64_t>(elapsed));
+        } catch(...) {}
+        PURE_CXX_POSIX_PROBE(copy__done, name, information.st_size);
+        span.mark(span::Copy);
+        if ((! trim(out.get(), size)) || (0 != ::close(out.release()))) { auto const code = errno; ::unlinkat(directory, name, 0); return Status::failure(code, "close"); }
+        reservation.written = true;
+        PURE_CXX_POSIX_PROBE(commit__done, name);
+        span.mark(span::Commit);
+        // the last reference of an unlinked file frees its blocks, that is a part of the unlink stage
+        in.reset();
+        if (0 != ::unlink(src.c_str())) return Status::failure(errno, "unlink");
+        PURE_CXX_POSIX_PROBE(unlink__done, name);
+        span.mark(span::Unlink);
+        return Status::success();
+    }
+
+    // seeds the table for a pair of filesystems with copies between unnamed temporary files, so nothing
+    // shows up in either directory; false when the filesystems don't support O_TMPFILE
+    inline static auto calibrate(strategy::Table &table, char const *source, char const *destination, ::std::uint64_t from, ::std::uint64_t to) noexcept(true) {
+        try {
+            auto in = Descriptor{::open(source, O_TMPFILE | O_RDWR | O_CLOEXEC, 0600)};
+            if (! in) return false;
+            ::std::array<char, 0x10000> block;
+            for (auto index = ::std::size_t{0}; index < block.size(); ++index) block[index] = static_cast<char>(index * 131);
+            auto length = ::std::uint64_t{0};
+            for (auto const size : {::std::uint64_t{0x4000}, ::std::uint64_t{0x80000}, ::std::uint64_t{0x400000}}) {
+                while (length < size) {
+                    auto const written = ::pwrite(in.get(), block.data(), static_cast<::std::size_t>(::std::min<::std::uint64_t>(block.size(), size - length)), static_cast<::off_t>(length));
+                    if (0 > written) return false;
+                    length += static_cast<::std::uint64_t>(written);
+                }
+                // files to move come from the disk, not from the cache the sample was just written into:
+                // the sample is written back once and dropped from the cache before every timed copy
+                if (0 != ::fdatasync(in.get())) return false;
+                for (auto method = ::std::size_t{0}; method < strategy::Count; ++method) for (auto trial = ::std::size_t{0}; trial < strategy::Table::trials; ++trial) {
+                    auto out = Descriptor{::open(destination, O_TMPFILE | O_WRONLY | O_CLOEXEC, 0600)};
+                    if ((! out) || (0 != ::lseek(in.get(), 0, SEEK_SET))) return false;
+                    ::posix_fadvise(in.get(), 0, 0, POSIX_FADV_DONTNEED);
+                    auto used = static_cast<strategy::Method>(method);
+                    auto const start = ::std::chrono::steady_clock::now();
+                    if (copy(in.get(), out.get(), used).failed()) return false;
+                    auto const elapsed = ::std::chrono::duration_cast<::std::chrono::nanoseconds>(::std::chrono::steady_clock::now() - start).count();
+                    table.record(from, to, size, static_cast<strategy::Method>(method), used, static_cast<::std::uint64_t>(elapsed));
+                }
+            }
+            return true;
+        } catch(...) {}
+        return false;
+    }
+
+    // a destination directory of a replicated move and the device it lives on
+    struct Target final { int directory = -1; ::std::uint64_t device = 0; };
+
+    constexpr static ::std::size_t const replicas = 8;
+
+    // copies src into every target and unlinks it once all of them committed: a target on the source
+    // filesystem gets a hardlink of it, the data is read once and written to the first target of every
+    // other filesystem, the rest of that filesystem get a reflink of that copy, or a hardlink without reflinks
+    inline static auto replicate(stdfs::path const &src, Target const *targets, ::std::size_t count, char const *name, Policy const &policy, Span &span) noexcept(true) {
+        PURE_CXX_POSIX_PROBE(move__start, name, src.c_str(), targets[0].directory);
+        if (replicas < count) return Status::failure(E2BIG, "replicate");
+        auto in = Descriptor{::open(src.c_str(), O_RDONLY | O_CLOEXEC)};
+        if (! in) return Status::failure(errno, "open");
+        struct ::stat information;
+        if (0 != ::fstat(in.get(), &information)) return Status::failure(errno, "fstat");
+        if (! S_ISREG(information.st_mode)) return Status::failure(EINVAL, "open");
+        // admission covers the destination, a hardlink of the source takes no space there
+        auto const bytes = static_cast<::std::uint64_t>(information.st_size);
+        space::Reservation reservation{policy.space, (static_cast<::std::uint64_t>(information.st_dev) == targets[0].device) ? 0 : bytes};
+        if (! reservation.admitted()) return Status::failure(ENOSPC, "admit");
+
+        // leaders[i] is the target whose copy target i reuses, i itself for a copy, count for a link of the source
+        ::std::array<::std::size_t, replicas> leaders;
+        ::std::array<Descriptor, replicas> outs;
+        ::std::array<bool, replicas> placed{};
+        auto const rollback = [&] (Status status) {
+            for (auto index = ::std::size_t{0}; index < count; ++index) if (placed[index]) ::unlinkat(targets[index].directory, name, 0);
+            return status;
+        };
+        auto const link = [&] (int directory, char const *source, ::std::size_t index) {
+            ::unlinkat(targets[index].directory, name, 0);
+            if (0 != ::linkat(directory, source, targets[index].directory, name, 0)) return false;
+            placed[index] = true; return true;
+        };
+
+        auto copies = ::std::size_t{0};
+        for (auto index = ::std::size_t{0}; index < count; ++index) {
+            auto const &target = targets[index];
+            if (static_cast<::std::uint64_t>(information.st_dev) == target.device) {
+                leaders[index] = count;
+                if (! link(AT_FDCWD, src.c_str(), index)) return rollback(Status::failure(errno, "linkat"));
+                continue;
+            }
+            leaders[index] = index;
+            for (auto other = ::std::size_t{0}; other < index; ++other) if ((leaders[other] == other) && (targets[other].device == target.device)) { leaders[index] = other; break; }
+            if (leaders[index] != index) continue;
+            outs[index].reset(::openat(target.directory, name, O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, information.st_mode & 07777));
+            if (! outs[index]) return rollback(Status::failure(errno, "openat"));
+            placed[index] = true; ++copies;
+            if (! preallocate(outs[index].get(), bytes)) return rollback(Status::failure(errno, "fallocate"));
+        }
+        PURE_CXX_POSIX_PROBE(open__done, name, information.st_size);
+        span.mark(span::Open);
+
+        // one copy goes through sendfile, several share one buffer, so the source is read once either way
+        auto const neutral = policy.neutral(bytes);
+        if (1 == copies) {
+            for (auto index = ::std::size_t{0}; index < count; ++index) if (outs[index]) {
+                auto const status = neutral ? engine::spill(in.get(), outs[index].get()) : engine::copy(in.get(), outs[index].get());
+                if (status.failed()) return rollback(status);
+            }
+        } else if (1 < copies) {
+            ::std::array<char, 0x40000> buffer;
+            auto total = ::off_t{0}, evicted = ::off_t{0};
+            while (true) {
+                for (; neutral && (evicted + eviction::chunk <= total); evicted += eviction::chunk) {
+                    for (auto index = ::std::size_t{0}; index < count; ++index) if (outs[index]) eviction::copied(in.get(), outs[index].get(), evicted, eviction::chunk);
+                }
+                auto const size = ::read(in.get(), buffer.data(), buffer.size());
+                if (0 == size) break;
+                if (0 > size) { if (EINTR == errno) continue; return rollback(Status::failure(errno, "read")); }
+                for (auto index = ::std::size_t{0}; index < count; ++index) if (outs[index]) {
+                    for (auto offset = ::ssize_t{0}; offset < size;) {
+                        auto const written = ::write(outs[index].get(), buffer.data() + offset, static_cast<::std::size_t>(size - offset));
+                        if (0 > written) { if (EINTR == errno) continue; return rollback(Status::failure(errno, "write")); }
+                        offset += written;
+                    }
+                }
+                total += size;
+            }
+            if (neutral) for (auto index = ::std::size_t{0}; index < count; ++index) if (outs[index]) eviction::finished(outs[index].get());
+        }
+        for (auto index = ::std::size_t{0}; index < count; ++index) if (outs[index] && (! trim(outs[index].get(), bytes))) return rollback(Status::failure(errno, "ftruncate"));
+        PURE_CXX_POSIX_PROBE(copy__done, name, information.st_size);
+        span.mark(span::Copy);
+
+        for (auto index = ::std::size_t{0}; index < count; ++index) {
+            auto const leader = leaders[index];
+            if ((count == leader) || (index == leader)) continue;
+            auto out = Descriptor{::openat(targets[index].directory, name, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, information.st_mode & 07777)};
+            if (! out) return rollback(Status::failure(errno, "openat"));
+            placed[index] = true;
+            if (0 == ::ioctl(out.get(), FICLONE, outs[leader].get())) { if (0 != ::close(out.release())) return rollback(Status::failure(errno, "close")); continue; }
+            out.reset();
+            if (! link(targets[leader].directory, name, index)) return rollback(Status::failure(errno, "linkat"));
+        }
+        for (auto index = ::std::size_t{0}; index < count; ++index) if (outs[index] && (0 != ::close(outs[index].release()))) return rollback(Status::failure(errno, "close"));
+        reservation.written = true;
+        PURE_CXX_POSIX_PROBE(commit__done, name);
+        span.mark(span::Commit);
+
+        in.reset();
+        if (0 != ::unlink(src.c_str())) return Status::failure(errno, "unlink");
+        PURE_CXX_POSIX_PROBE(unlink__done, name);
+        span.mark(span::Unlink);
+        return Status::success();
+    }
+
+    // streams src to a consumer and unlinks it once the consumer committed it; a broken
+    // connection is reset, so that the caller reconnects before the next file
+    inline static auto send(stdfs::path const &src, Descriptor &connection, ::std::string const &name, Policy const &policy, Span &span) noexcept(true) {
+        PURE_CXX_POSIX_PROBE(move__start, name.c_str(), src.c_str(), connection.get());
+        auto in = Descriptor{::open(src.c_str(), O_RDONLY | O_CLOEXEC)};
+        if (! in) return Status::failure(errno, "open");
+        struct ::stat information;
+        if (0 != ::fstat(in.get(), &information)) return Status::failure(errno, "fstat");
+        if (! S_ISREG(information.st_mode)) return Status::failure(EINVAL, "open");
+        PURE_CXX_POSIX_PROBE(open__done, name.c_str(), information.st_size);
+        span.mark(span::Open);
+
+        auto &&header = stream::Header{};
+        header.size = static_cast<::std::uint64_t>(information.st_size);
+        header.length = static_cast<::std::uint32_t>(name.size());
+        header.checksum = checksum::initial;
+        // the header carries the checksum, so it is read ahead in bounded chunks; a mapping would
+        // fault on a file truncated meanwhile, the chunks, a multiple of 8 bytes, just come up short
+        ::posix_fadvise(in.get(), 0, 0, POSIX_FADV_SEQUENTIAL);
+        ::std::array<char, 0x10000> buffer;
+        for (auto offset = ::std::uint64_t{0}; offset < header.size;) {
+            auto const wanted = static_cast<::std::size_t>(::std::min<::std::uint64_t>(buffer.size(), header.size - offset));
+            for (auto filled = ::std::size_t{0}; filled < wanted;) {
+                auto const count = ::pread(in.get(), buffer.data() + filled, wanted - filled, static_cast<::off_t>(offset + filled));
+                if ((0 > count) && (EINTR == errno)) continue;
+                if (0 > count) return Status::failure(errno, "pread");
+                // a shrunk file can't fill the size the header would announce
+                if (0 == count) return Status::failure(ENODATA, "pread");
+                filled += static_cast<::std::size_t>(count);
+            }
+            header.checksum = checksum::update(header.checksum, buffer.data(), wanted);
+            offset += wanted;
+        }
+        PURE_CXX_POSIX_PROBE(checksum__done, name.c_str(), header.size, header.checksum);
+        span.mark(span::Checksum);
+
+        auto const broken = [&connection] (int code, char const *operation) { connection.reset(); return Status::failure(code, operation); };
+        if (auto const code = stream::write(connection.get(), &header, sizeof(header))) return broken(code, "send");
+        if (auto const code = stream::write(connection.get(), name.data(), name.size())) return broken(code, "send");
+        for (auto offset = ::off_t{0}; static_cast<::std::uint64_t>(offset) < header.size;) {
+            auto const count = ::sendfile(connection.get(), in.get(), &offset, header.size - static_cast<::std::uint64_t>(offset));
+            if (0 < count) continue;
+            if ((0 > count) && (EINTR == errno)) continue;
+            // a shrunk file can't fill the announced size, the stream is out of sync
+            return broken((0 == count) ? ENODATA : errno, "sendfile");
+        }
+        PURE_CXX_POSIX_PROBE(copy__done, name.c_str(), header.size);
+        span.mark(span::Copy);
+
+        auto acknowledgement = static_cast<unsigned char>(stream::Failed);
+        if (auto const code = stream::read(connection.get(), &acknowledgement, 1)) return broken(code, "recv");
+        if (stream::Committed != acknowledgement) return Status::failure((stream::Corrupted == acknowledgement) ? EBADMSG : EREMOTEIO, "commit");
+        PURE_CXX_POSIX_PROBE(commit__done, name.c_str());
+        span.mark(span::Commit);
+        // the consumer has it, the pages the checksum and sendfile read are of no use anymore
+        if (policy.neutral(header.size)) ::posix_fadvise(in.get(), 0, 0, POSIX_FADV_DONTNEED);
+        in.reset();
+        if (0 != ::unlink(src.c_str())) return Status::failure(errno, "unlink");
+        PURE_CXX_POSIX_PROBE(unlink__done, name.c_str());
+        span.mark(span::Unlink);
+        return Status::success();
+    }
+
+} // namespace engine
+} // namespace pure_cxx_posix
+
+#else
+#error "__cplusplus not defined. c++14 or hight is required"
+#endif // defined(__cplusplus) && (201402L <= __cplusplus)
+#endif // PURE_CXX_POSIX_ENGINE_HPP
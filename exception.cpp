@@ -1,8 +1,13 @@
 #if defined(__cplusplus) && 201402L <= __cplusplus
 
+#include <cstdlib>
 #include <cstring>
 
 #include <list>
+#include <mutex>
+#include <memory>
+#include <vector>
+#include <unordered_map>
 #include <string>
 #include <sstream>
 #include <utility>
@@ -10,6 +15,9 @@
 #include <numeric>
 #include <type_traits>
 
+#include <dlfcn.h>
+#include <cxxabi.h>
+
 #include "exception.hpp"
 
 
@@ -51,11 +59,15 @@ namespace info {
     }
 
     Type Type::MakeHelper::implementation(Exception &&exception) noexcept(false) {
-        return Info{::std::move(exception.context), "::pure_cxx_posix::Exception", info::makeTextFromNode(::std::move(exception.attachment))};
+        auto &&info = Info{::std::move(exception.context), "::pure_cxx_posix::Exception", info::makeTextFromNode(::std::move(exception.attachment))};
+        info.backtrace = ::std::move(exception.backtrace);
+        return ::std::move(info);
     }
 
     Type Type::MakeHelper::implementation(Exception const &exception) noexcept(false) {
-        return Info{exception.context, "::pure_cxx_posix::Exception", info::makeTextFromNode(exception.attachment)};
+        auto &&info = Info{exception.context, "::pure_cxx_posix::Exception", info::makeTextFromNode(exception.attachment)};
+        info.backtrace = exception.backtrace;
+        return ::std::move(info);
     }
 
     Type Type::MakeHelper::implementation(::std::exception const &exception) noexcept(false) {
@@ -121,6 +133,40 @@ namespace info {
 
 } // namespace info
 
+namespace backtrace {
+
+    inline static auto symbolize(void const *address) noexcept(false) {
+        ::std::ostringstream stream; stream << ::std::hex;
+        auto info = ::Dl_info{};
+        if (0 == ::dladdr(address, &info)) { stream << address; return stream.str(); }
+        auto const base = static_cast<char const *>(static_cast<bool>(info.dli_sname) ? info.dli_saddr : info.dli_fbase);
+        if (static_cast<bool>(info.dli_sname)) {
+            auto status = 0;
+            auto const demangled = ::std::unique_ptr<char, void (*)(void *)>{::abi::__cxa_demangle(info.dli_sname, nullptr, nullptr, &status), ::std::free};
+            stream << (((0 == status) && static_cast<bool>(demangled)) ? demangled.get() : info.dli_sname);
+        }
+        stream << (static_cast<bool>(info.dli_sname) ? "+0x" : "0x") << (static_cast<char const *>(address) - base);
+        if (static_cast<bool>(info.dli_fname)) stream << " in " << info.dli_fname;
+        return stream.str();
+    }
+
+    ::std::vector<::std::string> Type::symbolize(Type const &backtrace) noexcept(false) {
+        static ::std::mutex mutex;
+        static ::std::unordered_map<void const *, ::std::string> cache;
+
+        ::std::vector<::std::string> result; result.reserve(backtrace.size);
+        auto const lock = ::std::unique_lock<::std::mutex>{mutex};
+        for (auto index = ::std::size_t{0}; index < backtrace.size; ++index) {
+            auto const address = backtrace.frames[index];
+            auto iterator = cache.find(address);
+            if (cache.end() == iterator) iterator = cache.emplace(address, backtrace::symbolize(address)).first;
+            result.push_back(iterator->second);
+        }
+        return result;
+    }
+
+} // namespace backtrace
+
     char const * Type::what() const noexcept(true) {
         if (static_cast<bool>(attachment)) {
             try { ::std::rethrow_exception(attachment); }
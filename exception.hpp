@@ -5,6 +5,8 @@
 #include "exception/fwd.hpp"
 #include "exception/trace.fwd.hpp"
 #include "exception/trace.hpp"
+#include "exception/backtrace.fwd.hpp"
+#include "exception/backtrace.hpp"
 #include "exception/type.fwd.hpp"
 #include "exception/type.hpp"
 #include "exception/info.fwd.hpp"
@@ -0,0 +1,26 @@
+#ifndef PURE_CXX_POSIX_EXCEPTION_BACKTRACE_FWD_HPP
+#define PURE_CXX_POSIX_EXCEPTION_BACKTRACE_FWD_HPP
+#pragma once
+#if defined(__cplusplus) && (201103L <= __cplusplus)
+
+#ifndef PURE_CXX_POSIX_EXCEPTION_BACKTRACE_DEPTH
+#define PURE_CXX_POSIX_EXCEPTION_BACKTRACE_DEPTH 32
+#endif // PURE_CXX_POSIX_EXCEPTION_BACKTRACE_DEPTH
+
+namespace pure_cxx_posix {
+namespace exception {
+namespace backtrace {
+
+    struct Type;
+
+} // namespace backtrace
+
+    using Backtrace = backtrace::Type;
+
+} // namespace exception
+} // namespace pure_cxx_posix
+
+#else
+#error "__cplusplus not defined. c++11 or hight is required"
+#endif // defined(__cplusplus) && (201103L <= __cplusplus)
+#endif // PURE_CXX_POSIX_EXCEPTION_BACKTRACE_FWD_HPP
@@ -0,0 +1,54 @@
+#ifndef PURE_CXX_POSIX_EXCEPTION_BACKTRACE_HPP
+#define PURE_CXX_POSIX_EXCEPTION_BACKTRACE_HPP
+#pragma once
+#if defined(__cplusplus) && (201402L <= __cplusplus)
+
+#include <array>
+#include <string>
+#include <vector>
+#include <cstddef>
+
+#include <execinfo.h>
+
+#include "backtrace.fwd.hpp"
+
+
+namespace pure_cxx_posix {
+namespace exception {
+namespace backtrace {
+
+    // raw return addresses only, symbols are resolved when the trace is rendered
+    struct Type final {
+        constexpr static ::std::size_t const depth = PURE_CXX_POSIX_EXCEPTION_BACKTRACE_DEPTH;
+
+        ::std::array<void *, depth> frames{};
+        ::std::size_t size = 0;
+
+        inline auto empty() const noexcept(true) { return 0 == size; }
+
+        inline static auto capture(::std::size_t skip = 0) noexcept(true);
+
+        static ::std::vector<::std::string> symbolize(Type const &) noexcept(false);
+    };
+
+    inline auto Type::capture(::std::size_t skip) noexcept(true) {
+        auto &&result = Type{};
+        if (0 == depth) return result;
+        void *buffer[depth + 8];
+        auto const count = ::backtrace(buffer, static_cast<int>(depth + 8));
+        for (auto index = skip + 1; (index < static_cast<::std::size_t>(0 < count ? count : 0)) && (result.size < depth); ++index) {
+            result.frames[result.size++] = buffer[index];
+        }
+        return result;
+    }
+
+    inline static auto symbolize(Type const &backtrace) noexcept(false) { return Type::symbolize(backtrace); }
+
+} // namespace backtrace
+} // namespace exception
+} // namespace pure_cxx_posix
+
+#else
+#error "__cplusplus not defined. c++14 or hight is required"
+#endif // defined(__cplusplus) && (201402L <= __cplusplus)
+#endif // PURE_CXX_POSIX_EXCEPTION_BACKTRACE_HPP
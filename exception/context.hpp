@@ -3,6 +3,8 @@
 #pragma once
 #if defined(__cplusplus) && (201402L <= __cplusplus)
 
+#include <cerrno>
+
 #include <string>
 #include <sstream>
 #include <utility>
@@ -22,6 +24,8 @@ namespace context {
     template <class ... T> static auto make(T && ...) noexcept(false);
 
     struct Type final {
+        // errno at the throw site, taken before anything else of the context is built
+        int code = 0;
         ::std::string file, function, line;
 
         inline auto isEmpty() const noexcept(false) { return file.empty() && function.empty() && line.empty(); }
@@ -65,14 +69,14 @@ namespace context {
         return makeStringFromLine(::std::forward<T>(value), static_cast<Conditional *>(nullptr));
     }
 
-    template <class T, class> inline Type::Type(T &&file) noexcept(false) : file{makeString(::std::forward<T>(file))} {}
+    template <class T, class> inline Type::Type(T &&file) noexcept(false) : code{errno}, file{makeString(::std::forward<T>(file))} {}
 
-    template <class fileT, class functionT> inline Type::Type(fileT &&file, functionT &&function) noexcept(false) :
+    template <class fileT, class functionT> inline Type::Type(fileT &&file, functionT &&function) noexcept(false) : code{errno},
         file{makeString(::std::forward<fileT>(file))}, function{makeString(::std::forward<functionT>(function))}
     {}
 
     template <class fileT, class functionT, class lineT>
-    inline Type::Type(fileT &&file, functionT &&function, lineT &&line) noexcept(false) :
+    inline Type::Type(fileT &&file, functionT &&function, lineT &&line) noexcept(false) : code{errno},
         file{makeString(::std::forward<fileT>(file))}, function{makeString(::std::forward<functionT>(function))},
         line{makeStringFromLine(::std::forward<lineT>(line))}
     {}
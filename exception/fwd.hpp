@@ -4,6 +4,7 @@
 #ifdef __cplusplus
 
 #include "trace.fwd.hpp"
+#include "backtrace.fwd.hpp"
 #include "type.fwd.hpp"
 #include "info.fwd.hpp"
 #include "context.fwd.hpp"
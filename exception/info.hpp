@@ -15,6 +15,7 @@
 #include "info.fwd.hpp"
 #include "type.hpp"
 #include "context.hpp"
+#include "backtrace.hpp"
 
 
 namespace pure_cxx_posix {
@@ -24,6 +25,7 @@ namespace info {
     struct Type final {
         Context context;
         ::std::string type{"unknown"}, message;
+        Backtrace backtrace;
 
         Type & operator = (Type &&) = default;
         Type & operator = (Type const &) = default;
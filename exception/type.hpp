@@ -10,6 +10,7 @@
 #include "type.fwd.hpp"
 #include "node.hpp"
 #include "context.hpp"
+#include "backtrace.hpp"
 #include "../not_object.hpp"
 
 #define PURE_CXX_POSIX_EXCEPTION_MAKE(attachment_and_reason...) ::pure_cxx_posix::exception::make(PURE_CXX_POSIX_EXCEPTION_CONTEXT_MAKE(), attachment_and_reason)
@@ -24,8 +25,10 @@ namespace exception {
     struct Type final : ::std::exception {
         using Node = ::pure_cxx_posix::exception::Node;
         using Context = ::pure_cxx_posix::exception::Context;
+        using Backtrace = ::pure_cxx_posix::exception::Backtrace;
 
         Context context; Node attachment, reason;
+        Backtrace backtrace;
 
         virtual char const * what() const noexcept(true) override final;
         template <class ... T> static auto make(T && ...) noexcept(false);
@@ -84,7 +87,11 @@ namespace exception {
     };
 
 
-    template <class ... T> inline auto Type::make(T && ... something) noexcept(false) { return Type{::std::forward<T>(something) ...}; }
+    template <class ... T> inline auto Type::make(T && ... something) noexcept(false) {
+        auto &&result = Type{::std::forward<T>(something) ...};
+        if (result.backtrace.empty()) result.backtrace = Backtrace::capture(1);
+        return result;
+    }
 
     template <class T> struct Type::MagicCtorTypePackItemTraits final : private NotObject { using Type = Node; };
     template <> struct Type::MagicCtorTypePackItemTraits<Type::Context> final : private NotObject { using Type = Context; };
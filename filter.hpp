@@ -0,0 +1,206 @@
+#ifndef PURE_CXX_POSIX_FILTER_HPP
+#define PURE_CXX_POSIX_FILTER_HPP
+#pragma once
+#if defined(__cplusplus) && (201402L <= __cplusplus)
+
+#include <cstdint>
+#include <cstring>
+
+#include <map>
+#include <array>
+#include <bitset>
+#include <string>
+#include <vector>
+#include <utility>
+#include <algorithm>
+#include <stdexcept>
+
+#include "exception.hpp"
+#include "utils.hpp"
+
+
+namespace pure_cxx_posix {
+namespace filter {
+
+    using Patterns = ::std::vector<::std::string>;
+
+    namespace glob {
+
+        // one step of a glob: a set of bytes, or a star that matches any run of bytes
+        struct Token final { ::std::bitset<256> set; bool star = false; };
+
+        inline static auto compile(::std::string const &pattern) noexcept(false) {
+            ::std::vector<Token> tokens;
+            for (auto index = ::std::size_t{0}; index < pattern.size(); ++index) {
+                auto const symbol = static_cast<unsigned char>(pattern[index]);
+                auto &&token = Token{};
+                if ('*' == symbol) { if (tokens.empty() || (! tokens.back().star)) { token.star = true; tokens.push_back(::std::move(token)); } continue; }
+                if ('?' == symbol) token.set.set();
+                else if ('[' == symbol) {
+                    auto cursor = index + 1;
+                    auto const negate = (cursor < pattern.size()) && (('!' == pattern[cursor]) || ('^' == pattern[cursor]));
+                    if (negate) ++cursor;
+                    auto first = true;
+                    for (; (cursor < pattern.size()) && (first || (']' != pattern[cursor])); ++cursor, first = false) {
+                        auto const from = static_cast<unsigned char>(pattern[cursor]);
+                        if ((cursor + 2 < pattern.size()) && ('-' == pattern[cursor + 1]) && (']' != pattern[cursor + 2])) {
+                            auto const to = static_cast<unsigned char>(pattern[cursor + 2]);
+                            for (auto value = static_cast<unsigned int>(from); value <= to; ++value) token.set.set(value);
+                            cursor += 2;
+                        } else token.set.set(from);
+                    }
+                    if (! (cursor < pattern.size())) throw PURE_CXX_POSIX_EXCEPTION_MAKE(::std::runtime_error{"unterminated [ in pattern " + pattern});
+                    if (negate) token.set.flip();
+                    index = cursor;
+                } else if (('\\' == symbol) && (index + 1 < pattern.size())) token.set.set(static_cast<unsigned char>(pattern[++index]));
+                else token.set.set(symbol);
+                tokens.push_back(::std::move(token));
+            }
+            return tokens;
+        }
+
+        // "*literal" without other metacharacters
+        inline static auto suffix(::std::string const &pattern, ::std::string &result) noexcept(false) {
+            if ((pattern.size() < 2) || ('*' != pattern.front())) return false;
+            if (::std::string::npos != pattern.find_first_of("*?[\\", 1)) return false;
+            result = pattern.substr(1);
+            return true;
+        }
+
+    } // namespace glob
+
+    // include and exclude globs matched against base names: a name passes when it matches no exclude
+    // and, if there are includes, at least one include; suffix-only rules bypass the automaton,
+    // everything else is compiled into a single dfa whose states carry both verdicts
+    struct Type final {
+        constexpr static ::std::size_t const limit = 4096;
+
+        inline auto empty() const noexcept(true) { return mEmpty; }
+
+        template <class T> inline auto accepts(T const &name) const noexcept(true);
+
+        inline Type(Patterns const &include, Patterns const &exclude) noexcept(false);
+
+    private:
+        constexpr static ::std::uint8_t const included = 1, excluded = 2;
+        using State = ::std::uint32_t;
+
+        bool mEmpty = true, mIncludes = false;
+        Patterns mIncludeSuffixes, mExcludeSuffixes;
+        ::std::vector<State> mTable;
+        ::std::vector<::std::uint8_t> mFlags;
+
+        inline auto match(char const *name, ::std::size_t size) const noexcept(true);
+        inline auto build(::std::vector<::std::pair<::std::vector<glob::Token>, ::std::uint8_t>> const &patterns) noexcept(false);
+    };
+
+    inline auto Type::build(::std::vector<::std::pair<::std::vector<glob::Token>, ::std::uint8_t>> const &patterns) noexcept(false) {
+        // nfa state is (pattern, position), a star position loops on itself
+        using Position = ::std::pair<::std::uint32_t, ::std::uint32_t>;
+        using Set = ::std::vector<Position>;
+
+        auto const close = [&patterns] (Set &set) {
+            for (auto index = ::std::size_t{0}; index < set.size(); ++index) {
+                auto const &tokens = patterns[set[index].first].first;
+                if ((set[index].second < tokens.size()) && tokens[set[index].second].star) {
+                    auto const next = Position{set[index].first, set[index].second + 1};
+                    if (set.end() == ::std::find(set.begin(), set.end(), next)) set.push_back(next);
+                }
+            }
+            ::std::sort(set.begin(), set.end());
+        };
+
+        auto const flags = [&patterns] (Set const &set) {
+            auto result = ::std::uint8_t{0};
+            for (auto const &item : set) if (item.second == patterns[item.first].first.size()) result |= patterns[item.first].second;
+            return result;
+        };
+
+        ::std::map<Set, State> states;
+        ::std::vector<Set> queue;
+        auto const intern = [&] (Set &&set) {
+            auto const iterator = states.find(set);
+            if (states.end() != iterator) return iterator->second;
+            if (! (states.size() < limit)) throw PURE_CXX_POSIX_EXCEPTION_MAKE(::std::runtime_error{"filter patterns are too complex"});
+            auto const state = static_cast<State>(states.size());
+            mFlags.push_back(flags(set));
+            mTable.resize(mTable.size() + 256, 0);
+            states.emplace(set, state);
+            queue.push_back(::std::move(set));
+            return state;
+        };
+
+        intern(Set{});
+        auto &&start = Set{};
+        for (auto index = ::std::uint32_t{0}; index < patterns.size(); ++index) start.emplace_back(index, 0);
+        close(start); intern(::std::move(start));
+
+        for (auto current = ::std::size_t{1}; current < queue.size(); ++current) {
+            for (auto symbol = 0; symbol < 256; ++symbol) {
+                auto &&next = Set{};
+                for (auto const &item : queue[current]) {
+                    auto const &tokens = patterns[item.first].first;
+                    if (! (item.second < tokens.size())) continue;
+                    auto const &token = tokens[item.second];
+                    if (token.star) next.push_back(item);
+                    else if (token.set.test(static_cast<::std::size_t>(symbol))) next.emplace_back(item.first, item.second + 1);
+                }
+                ::std::sort(next.begin(), next.end()); next.erase(::std::unique(next.begin(), next.end()), next.end());
+                close(next);
+                auto const state = next.empty() ? State{0} : intern(::std::move(next));
+                mTable[current * 256 + static_cast<::std::size_t>(symbol)] = state;
+            }
+        }
+    }
+
+    inline Type::Type(Patterns const &include, Patterns const &exclude) noexcept(false) {
+        ::std::vector<::std::pair<::std::vector<glob::Token>, ::std::uint8_t>> patterns;
+        auto &&suffix = ::std::string{};
+        for (auto const &pattern : include) {
+            if (glob::suffix(pattern, suffix)) mIncludeSuffixes.push_back(suffix);
+            else patterns.emplace_back(glob::compile(pattern), ::std::uint8_t{included});
+        }
+        for (auto const &pattern : exclude) {
+            if (glob::suffix(pattern, suffix)) mExcludeSuffixes.push_back(suffix);
+            else patterns.emplace_back(glob::compile(pattern), ::std::uint8_t{excluded});
+        }
+        mIncludes = ! include.empty();
+        mEmpty = include.empty() && exclude.empty();
+        if (! patterns.empty()) build(patterns);
+    }
+
+    inline auto Type::match(char const *name, ::std::size_t size) const noexcept(true) {
+        auto const ends = [name, size] (::std::string const &suffix) {
+            return (suffix.size() <= size) && (0 == ::std::memcmp(name + size - suffix.size(), suffix.data(), suffix.size()));
+        };
+        for (auto const &suffix : mExcludeSuffixes) if (ends(suffix)) return false;
+        auto verdict = ::std::uint8_t{0};
+        if (! mTable.empty()) {
+            auto state = State{1};
+            for (auto index = ::std::size_t{0}; (index < size) && (0 != state); ++index) state = mTable[state * 256 + static_cast<unsigned char>(name[index])];
+            verdict = mFlags[state];
+        }
+        if (0 != (verdict & excluded)) return false;
+        if ((! mIncludes) || (0 != (verdict & included))) return true;
+        for (auto const &suffix : mIncludeSuffixes) if (ends(suffix)) return true;
+        return false;
+    }
+
+    // one pass of the dfa over the base name, cheaper than hashing it for a cache of verdicts
+    template <class T> inline auto Type::accepts(T const &name) const noexcept(true) {
+        if (mEmpty) return true;
+        auto const slash = name.rfind('/');
+        auto const offset = (decltype(name.size())(-1) == slash) ? 0 : slash + 1;
+        return match(name.data() + offset, name.size() - offset);
+    }
+
+} // namespace filter
+
+    using Filter = filter::Type;
+
+} // namespace pure_cxx_posix
+
+#else
+#error "__cplusplus not defined. c++14 or hight is required"
+#endif // defined(__cplusplus) && (201402L <= __cplusplus)
+#endif // PURE_CXX_POSIX_FILTER_HPP
@@ -0,0 +1,138 @@
+#ifndef PURE_CXX_POSIX_GOVERNOR_HPP
+#define PURE_CXX_POSIX_GOVERNOR_HPP
+#pragma once
+#if defined(__cplusplus) && (201402L <= __cplusplus)
+
+#include <cerrno>
+#include <cstdint>
+#include <cstdlib>
+
+#include <string>
+#include <utility>
+#include <algorithm>
+#include <stdexcept>
+
+#include <sched.h>
+#include <unistd.h>
+#include <sys/time.h>
+#include <sys/syscall.h>
+#include <sys/resource.h>
+
+#include "config.hpp"
+#include "logger.hpp"
+#include "exception.hpp"
+#include "utils.hpp"
+
+
+namespace pure_cxx_posix {
+namespace governor {
+
+    using Profile = config::Type::Profile;
+
+    enum IoClass : ::std::int32_t { None = 0, Realtime = 1, BestEffort = 2, Idle = 3 };
+
+    // "0-3,6" style cpu list, empty for every cpu the process started with
+    inline static auto cpus(::std::string const &list) noexcept(false) {
+        static auto const original = [] () { ::cpu_set_t set; CPU_ZERO(&set); ::sched_getaffinity(0, sizeof(set), &set); return set; } ();
+        if (list.empty()) return original;
+        ::cpu_set_t set; CPU_ZERO(&set);
+        auto const invalid = [&list] () { return PURE_CXX_POSIX_EXCEPTION_MAKE(::std::runtime_error{"invalid cpu list: " + list}); };
+        for (auto cursor = list.c_str(); 0 != *cursor;) {
+            char *end = nullptr;
+            auto const first = ::std::strtol(cursor, &end, 10);
+            if ((end == cursor) || (0 > first)) throw invalid();
+            auto last = first;
+            if ('-' == *end) { cursor = end + 1; last = ::std::strtol(cursor, &end, 10); if ((end == cursor) || (last < first)) throw invalid(); }
+            if (! (last < CPU_SETSIZE)) throw invalid();
+            for (auto cpu = first; cpu <= last; ++cpu) CPU_SET(static_cast<int>(cpu), &set);
+            if (',' == *end) ++end; else if (0 != *end) throw invalid();
+            cursor = end;
+        }
+        return set;
+    }
+
+    // "none", "idle", "be/N" or "rt/N"
+    inline static auto io(::std::string const &value, Profile &profile) noexcept(false) {
+        auto const level = [&value] (::std::size_t offset) {
+            if (! ((offset + 1 == value.size()) && ('0' <= value[offset]) && ('7' >= value[offset]))) {
+                throw PURE_CXX_POSIX_EXCEPTION_MAKE(::std::runtime_error{"invalid io priority: " + value});
+            }
+            return static_cast<::std::int32_t>(value[offset] - '0');
+        };
+        if ("none" == value) { profile.ioClass = IoClass::None; profile.ioLevel = 0; }
+        else if ("idle" == value) { profile.ioClass = IoClass::Idle; profile.ioLevel = 0; }
+        else if (0 == value.compare(0, 3, "be/")) { profile.ioClass = IoClass::BestEffort; profile.ioLevel = level(3); }
+        else if (0 == value.compare(0, 3, "rt/")) { profile.ioClass = IoClass::Realtime; profile.ioLevel = level(3); }
+        else throw PURE_CXX_POSIX_EXCEPTION_MAKE(::std::runtime_error{"invalid io priority: " + value});
+        profile.given.io = true;
+    }
+
+    // what threads inherit from the process, taken by the first thread that applies a profile, before it does
+    struct Baseline final {
+        ::cpu_set_t cpus;
+        int nice = 0, policy = SCHED_OTHER;
+        ::sched_param parameters{};
+        long io = 0;
+    };
+
+    inline static auto baseline() noexcept(true) {
+        auto const tid = static_cast<::pid_t>(::syscall(SYS_gettid));
+        auto &&result = Baseline{};
+        result.cpus = governor::cpus(::std::string{});
+        errno = 0;
+        auto const nice = ::getpriority(PRIO_PROCESS, static_cast<::id_t>(tid));
+        if (0 == errno) result.nice = nice;
+        auto const policy = ::sched_getscheduler(0);
+        if ((0 <= policy) && (0 == ::sched_getparam(0, &result.parameters))) result.policy = policy;
+        result.io = ::std::max(::syscall(SYS_ioprio_get, 1, tid), 0L);
+        return ::std::move(result);
+    }
+
+    // applies the attributes the profile gives to the calling thread; one it doesn't give goes back to the
+    // baseline when a previous profile of the thread had set it, so switching profiles keeps nothing of the
+    // previous one and a daemon started with nice or ionice keeps them; failures are logged if asked
+    inline static auto apply(Profile const &profile, bool report) noexcept(true) {
+        static auto const original = governor::baseline();
+        thread_local auto applied = Profile::Given{};
+        auto const tid = static_cast<::pid_t>(::syscall(SYS_gettid));
+        auto const &given = profile.given;
+        auto result = true;
+        auto const failed = [report, &result] (char const *operation) {
+            result = false;
+            if (report) Logger::instance<Logger::Category::Error>() << "Failed to apply resource profile, " << operation << "(): " << utils::errorCodeToString();
+        };
+        if (given.cpus || applied.cpus) try {
+            auto const set = given.cpus ? governor::cpus(profile.cpus) : original.cpus;
+            if (0 != ::sched_setaffinity(0, sizeof(set), &set)) failed("sched_setaffinity");
+        } catch(...) { failed("sched_setaffinity"); }
+        if (given.idle || applied.idle) {
+            auto const parameters = given.idle ? ::sched_param{} : original.parameters;
+            if (0 != ::sched_setscheduler(0, given.idle ? (profile.idle ? SCHED_IDLE : SCHED_OTHER) : original.policy, &parameters)) failed("sched_setscheduler");
+        }
+        if ((given.nice || applied.nice) && (0 != ::setpriority(PRIO_PROCESS, static_cast<::id_t>(tid), given.nice ? profile.nice : original.nice))) failed("setpriority");
+        if ((given.io || applied.io) && (0 != ::syscall(SYS_ioprio_set, 1, tid, given.io ? ((profile.ioClass << 13) | profile.ioLevel) : original.io))) failed("ioprio_set");
+        applied = given;
+        return result;
+    }
+
+    inline static auto describe(Profile const &profile) noexcept(false) {
+        static char const * const classes[] = {"none", "rt", "be", "idle"};
+        auto &&result = ::std::string{};
+        auto const append = [&result] (::std::string const &text) { result.append(result.empty() ? "[" : ", ").append(text); };
+        if (profile.given.cpus) append("cpus " + (profile.cpus.empty() ? ::std::string{"all"} : profile.cpus));
+        if (profile.given.nice) append("nice " + ::std::to_string(profile.nice));
+        if (profile.given.idle) append(profile.idle ? "sched_idle" : "sched_other");
+        if (profile.given.io) {
+            append(::std::string{"io "} + classes[profile.ioClass & 3]);
+            if ((IoClass::Realtime == profile.ioClass) || (IoClass::BestEffort == profile.ioClass)) result += "/" + ::std::to_string(profile.ioLevel);
+        }
+        return result.empty() ? ::std::string{"inherited"} : result + "]";
+    }
+
+} // namespace governor
+} // namespace pure_cxx_posix
+
+#else
+#error "__cplusplus not defined. c++14 or hight is required"
+#endif // defined(__cplusplus) && (201402L <= __cplusplus)
+#endif // PURE_CXX_POSIX_GOVERNOR_HPP
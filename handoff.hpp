@@ -0,0 +1,431 @@
+#ifndef PURE_CXX_POSIX_HANDOFF_HPP
+#define PURE_CXX_POSIX_HANDOFF_HPP
+#pragma once
+#if defined(__cplusplus) && (201402L <= __cplusplus)
+
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+
+#include <map>
+#include <array>
+#include <chrono>
+#include <string>
+#include <sstream>
+#include <utility>
+#include <algorithm>
+#include <stdexcept>
+#include <functional>
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/un.h>
+#include <sys/time.h>
+#include <sys/stat.h>
+#include <sys/socket.h>
+
+#include "poller.hpp"
+#include "backlog.hpp"
+#include "logger.hpp"
+#include "reactor.hpp"
+#include "context.hpp"
+#include "exception.hpp"
+#include "descriptor.hpp"
+#include "utils.hpp"
+#include "stdfs.hpp"
+
+
+namespace pure_cxx_posix {
+namespace handoff {
+
+    // what a running instance passes to its successor: open source and destination directories,
+    // the poller state and the names it listed but did not move yet
+    struct State final {
+        double interval = +0.0e+0;
+        poller::Stamp stamp;
+        Backlog pending;
+        Descriptor src, dst;
+        bool valid = false;
+    };
+
+    struct Session final {
+        Descriptor connection;
+        State state;
+    };
+
+    // seconds the successor waits for the state, the predecessor first finishes the files in flight;
+    // and the predecessor waits for the state to leave and be acknowledged, which is quick unless the successor hangs
+    constexpr static ::time_t const drain = 300;
+    constexpr static ::time_t const patience = 5;
+
+    inline static auto timeout(Descriptor const &connection, int option, ::time_t seconds) noexcept(true) {
+        auto const value = ::timeval{seconds, 0};
+        ::setsockopt(connection.get(), SOL_SOCKET, option, &value, sizeof(value));
+    }
+
+    inline constexpr static auto const * hello() noexcept(true) { return "pcxxpd-handoff 1\n"; }
+    inline constexpr static char acknowledgement() noexcept(true) { return 'A'; }
+
+    inline static ::std::string path() noexcept(false) {
+        auto const &&name = utils::copy(Context::instance().name);
+        return stdfs::absolute((name.empty() ? ::std::string{utils::defaultName()} : ::std::move(name)) + ".handoff", "/var/run");
+    }
+
+    inline static auto makeAddress(::std::string const &path) noexcept(false) {
+        auto address = ::sockaddr_un{}; address.sun_family = AF_UNIX;
+        if (! (path.size() < sizeof(address.sun_path))) throw PURE_CXX_POSIX_EXCEPTION_MAKE(::std::invalid_argument{"handoff socket path is too long"});
+        ::std::memcpy(address.sun_path, path.c_str(), path.size() + 1);
+        return address;
+    }
+
+    template <class T> inline static auto writeAll(Descriptor const &descriptor, T const *data, ::std::size_t size) noexcept(false) {
+        auto const *pointer = reinterpret_cast<char const *>(data);
+        while (0 < size) {
+            auto const count = ::send(descriptor.get(), pointer, size, MSG_NOSIGNAL);
+            if (0 > count) {
+                if (EINTR == errno) continue;
+                throw PURE_CXX_POSIX_EXCEPTION_MAKE(::std::runtime_error{"handoff send() failure: " + utils::errorCodeToString()});
+            }
+            pointer += count; size -= static_cast<::std::size_t>(count);
+        }
+    }
+
+    template <class T> inline static auto readAll(Descriptor const &descriptor, T *data, ::std::size_t size) noexcept(false) {
+        auto *pointer = reinterpret_cast<char *>(data);
+        while (0 < size) {
+            auto const count = ::read(descriptor.get(), pointer, size);
+            if (0 > count) {
+                if (EINTR == errno) continue;
+                throw PURE_CXX_POSIX_EXCEPTION_MAKE(::std::runtime_error{"handoff read() failure: " + utils::errorCodeToString()});
+            }
+            if (0 == count) throw PURE_CXX_POSIX_EXCEPTION_MAKE(::std::runtime_error{"handoff connection closed unexpectedly"});
+            pointer += count; size -= static_cast<::std::size_t>(count);
+        }
+    }
+
+    inline static auto serialize(State const &state) noexcept(false) {
+        ::std::ostringstream stream; stream.precision(17);
+        stream << state.interval << ' ' << state.stamp.valid << ' ' << state.stamp.device << ' ' << state.stamp.inode << ' '
+               << state.stamp.mtime << ' ' << state.stamp.ctime << ' ' << state.pending.size() << '\n';
+        for (auto index = ::std::size_t{0}; index < state.pending.size(); ++index) {
+            auto const name = state.pending[index];
+            stream << name.size() << ':'; stream.write(name.data(), static_cast<::std::streamsize>(name.size()));
+        }
+        return stream.str();
+    }
+
+    inline static auto deserialize(::std::string const &blob, State &state) noexcept(false) {
+        ::std::istringstream stream{blob};
+        stream.exceptions(stream.failbit | stream.badbit);
+        auto count = ::std::size_t{0};
+        stream >> state.interval >> state.stamp.valid >> state.stamp.device >> state.stamp.inode >> state.stamp.mtime >> state.stamp.ctime >> count;
+        if ('\n' != stream.get()) throw PURE_CXX_POSIX_EXCEPTION_MAKE(::std::runtime_error{"invalid handoff state"});
+        auto &&name = ::std::string{};
+        while (0 < count--) {
+            auto size = ::std::size_t{0}; stream >> size;
+            if (':' != stream.get()) throw PURE_CXX_POSIX_EXCEPTION_MAKE(::std::runtime_error{"invalid handoff state"});
+            name.resize(size); stream.read(&name[0], static_cast<::std::streamsize>(size));
+            state.pending.push(name);
+        }
+    }
+
+    // only the identity of the path travels, so a socket destination works as well as a directory
+    template <class T> inline static auto openPath(T const &path) noexcept(false) {
+        auto &&descriptor = Descriptor{::open(path.c_str(), O_PATH | O_CLOEXEC)};
+        if (! descriptor) throw PURE_CXX_POSIX_EXCEPTION_MAKE(::std::runtime_error{"failed to open " + ::std::string{path} + ": " + utils::errorCodeToString()});
+        return ::std::move(descriptor);
+    }
+
+    // true when the received descriptor is the directory the path names
+    template <class T> inline static auto matches(Descriptor const &descriptor, T const &path) noexcept(true) {
+        struct ::stat a, b;
+        if (0 != ::fstat(descriptor.get(), &a)) return false;
+        if (0 != ::stat(path.c_str(), &b)) return false;
+        return (a.st_dev == b.st_dev) && (a.st_ino == b.st_ino);
+    }
+
+    // predecessor side: nonblocking listener for the reactor, created with its final mode like the control socket
+    inline static auto listen() noexcept(false) {
+        auto const &&path = handoff::path();
+        auto const address = makeAddress(path);
+        auto &&descriptor = Descriptor{::socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0)};
+        if (! descriptor) throw PURE_CXX_POSIX_EXCEPTION_MAKE(::std::runtime_error{"handoff socket() failure: " + utils::errorCodeToString()});
+        ::unlink(path.c_str());
+        auto const mask = ::umask(077);
+        auto const bound = ::bind(descriptor.get(), reinterpret_cast<::sockaddr const *>(&address), sizeof(address));
+        auto const code = errno;
+        ::umask(mask);
+        if (0 != bound) throw PURE_CXX_POSIX_EXCEPTION_MAKE(::std::runtime_error{"handoff bind() failure: " + utils::errorCodeToString(code)});
+        if (0 != ::listen(descriptor.get(), 1)) throw PURE_CXX_POSIX_EXCEPTION_MAKE(::std::runtime_error{"handoff listen() failure: " + utils::errorCodeToString()});
+        return ::std::move(descriptor);
+    }
+
+    // a successor runs as the same user, anyone else would drain the route and get its directories
+    inline static auto trusted(Descriptor const &connection) noexcept(true) {
+        auto credentials = ::ucred{};
+        auto size = static_cast<::socklen_t>(sizeof(credentials));
+        if (0 != ::getsockopt(connection.get(), SOL_SOCKET, SO_PEERCRED, &credentials, &size)) return false;
+        return (static_cast<::socklen_t>(sizeof(credentials)) == size) && (::geteuid() == credentials.uid);
+    }
+
+    // the next pending connection of the same user, an empty descriptor when there is none
+    inline static auto accept(Descriptor const &listener) noexcept(true) {
+        while (true) {
+            auto &&connection = Descriptor{::accept4(listener.get(), nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC)};
+            if ((! connection) || trusted(connection)) return ::std::move(connection);
+        }
+    }
+
+    // predecessor side of one connection, nonblocking and edge-triggered in the reactor like a control session:
+    // the greeting comes in within a second, later the state goes out and the acknowledgement comes back
+    // within patience, a peer that stalls in any step never holds the reactor thread
+    struct Peer final {
+        using Clock = ::std::chrono::steady_clock;
+
+        enum class Step { Wait, Done, Close };
+
+        Descriptor connection;
+        ::std::string input, output;
+        bool sent = false;
+        Clock::time_point deadline = Clock::now() + ::std::chrono::seconds{1};
+
+        inline explicit operator bool () const noexcept(true) { return static_cast<bool>(connection); }
+
+        // Done once the whole greeting arrived, Close for anything that doesn't greet as a successor
+        inline auto greet() noexcept(true) {
+            auto const size = ::std::strlen(hello());
+            ::std::array<char, 32> buffer;
+            while (input.size() < size) {
+                auto const count = ::recv(connection.get(), buffer.data(), ::std::min(buffer.size(), size - input.size()), 0);
+                if ((0 > count) && (EINTR == errno)) continue;
+                if ((0 > count) && ((EAGAIN == errno) || (EWOULDBLOCK == errno))) return Step::Wait;
+                if (0 >= count) return Step::Close;
+                input.append(buffer.data(), static_cast<::std::size_t>(count));
+            }
+            return (hello() == input) ? Step::Done : Step::Close;
+        }
+
+        // the size and the descriptors go out at once, the socket buffer of a fresh connection holds them;
+        // the names are queued for proceed()
+        inline auto send(State const &state) noexcept(false) {
+            auto &&blob = serialize(state);
+            auto size = static_cast<::std::uint64_t>(blob.size());
+            auto const descriptors = ::std::array<int, 2>{{state.src.get(), state.dst.get()}};
+
+            alignas(::cmsghdr) char control[CMSG_SPACE(sizeof(descriptors))] = {};
+            auto vector = ::iovec{&size, sizeof(size)};
+            auto message = ::msghdr{};
+            message.msg_iov = &vector; message.msg_iovlen = 1;
+            message.msg_control = control; message.msg_controllen = sizeof(control);
+            auto * const header = CMSG_FIRSTHDR(&message);
+            header->cmsg_level = SOL_SOCKET; header->cmsg_type = SCM_RIGHTS; header->cmsg_len = CMSG_LEN(sizeof(descriptors));
+            ::std::memcpy(CMSG_DATA(header), descriptors.data(), sizeof(descriptors));
+
+            while (static_cast<::ssize_t>(sizeof(size)) != ::sendmsg(connection.get(), &message, MSG_NOSIGNAL)) {
+                if (EINTR == errno) continue;
+                throw PURE_CXX_POSIX_EXCEPTION_MAKE(::std::runtime_error{"handoff sendmsg() failure: " + utils::errorCodeToString()});
+            }
+            output = ::std::move(blob);
+            sent = true;
+            deadline = Clock::now() + ::std::chrono::seconds{patience};
+        }
+
+        // sends what the socket takes, then reads the acknowledgement: Done once it came back,
+        // Close when the successor went away without it
+        inline auto proceed() noexcept(true) {
+            while (! output.empty()) {
+                auto const count = ::send(connection.get(), output.data(), output.size(), MSG_NOSIGNAL);
+                if ((0 > count) && (EINTR == errno)) continue;
+                if ((0 > count) && ((EAGAIN == errno) || (EWOULDBLOCK == errno))) return Step::Wait;
+                if (0 > count) return Step::Close;
+                output.erase(0, static_cast<::std::size_t>(count));
+            }
+            auto symbol = char{0};
+            while (true) {
+                auto const count = ::recv(connection.get(), &symbol, 1, 0);
+                if ((0 > count) && (EINTR == errno)) continue;
+                if ((0 > count) && ((EAGAIN == errno) || (EWOULDBLOCK == errno))) return Step::Wait;
+                return ((1 == count) && (acknowledgement() == symbol)) ? Step::Done : Step::Close;
+            }
+        }
+    };
+
+    // predecessor side in a reactor: connections greet within a second, the first one that does is the successor
+    // and connected is called; finished is called with true once it acknowledged the state sent to it, with false
+    // when it went away or didn't acknowledge within patience, the successor is forgotten by then
+    struct Server final {
+        using Connected = ::std::function<void()>;
+        using Finished = ::std::function<void(bool)>;
+
+        // connections greeting at a time, one that comes past them or while a successor drains the route
+        // is closed right away, nothing is read from it
+        constexpr static ::std::size_t const capacity = 4;
+
+        inline explicit operator bool () const noexcept(true) { return static_cast<bool>(mSuccessor); }
+
+        inline auto send(State const &state) noexcept(false);
+        inline auto forget() noexcept(false) -> void;
+
+        inline explicit Server(Reactor &reactor, Descriptor &&listener, Connected &&connected, Finished &&finished) noexcept(false);
+
+        Server(Server &&) = delete;
+        Server(Server const &) = delete;
+        template <class T> Server & operator = (T &&) = delete;
+
+    private:
+        Reactor &mReactor;
+        Descriptor mListener, mDeadline;
+        Connected mConnected;
+        Finished mFinished;
+        Peer mSuccessor;
+        ::std::map<int, Peer> mCandidates;
+
+        inline auto admit() noexcept(false) -> void;
+        inline auto handshake(int descriptor) noexcept(false) -> void;
+        inline auto proceed() noexcept(false) -> void;
+        inline auto dismiss(int descriptor) noexcept(false) -> void;
+        inline auto expire() noexcept(false) -> void;
+        inline auto remind() noexcept(false) -> void;
+    };
+
+    inline Server::Server(Reactor &reactor, Descriptor &&listener, Connected &&connected, Finished &&finished) noexcept(false)
+        : mReactor{reactor}, mListener{::std::move(listener)}, mDeadline{reactor::timer::make()}, mConnected{::std::move(connected)}, mFinished{::std::move(finished)} {
+        if (! mListener) return;
+        mReactor.add(mListener.get(), EPOLLIN, [this] (auto) { admit(); });
+        mReactor.add(mDeadline.get(), EPOLLIN, [this] (auto) { expire(); });
+    }
+
+    inline auto Server::send(State const &state) noexcept(false) {
+        mSuccessor.send(state);
+        Logger::instance() << "State handed off with " << state.pending.size() << " pending files, waiting for acknowledgement";
+        remind();
+        // the connection is edge-triggered, what the socket takes right away goes out here
+        proceed();
+    }
+
+    inline auto Server::forget() noexcept(false) -> void {
+        if (mSuccessor) mReactor.remove(mSuccessor.connection.get());
+        mSuccessor = Peer{};
+        remind();
+    }
+
+    inline auto Server::admit() noexcept(false) -> void {
+        for (auto &&connection = accept(mListener); connection; connection = accept(mListener)) {
+            if (mSuccessor || (! (mCandidates.size() < capacity))) continue;
+            auto const descriptor = connection.get();
+            mCandidates[descriptor].connection = ::std::move(connection);
+            try { mReactor.add(descriptor, EPOLLIN | EPOLLOUT | EPOLLET, [this, descriptor] (auto) { handshake(descriptor); }); }
+            catch(...) { mCandidates.erase(descriptor); continue; }
+            remind();
+        }
+    }
+
+    inline auto Server::handshake(int descriptor) noexcept(false) -> void {
+        if (mSuccessor && (mSuccessor.connection.get() == descriptor)) return proceed();
+        auto const iterator = mCandidates.find(descriptor);
+        if (mCandidates.end() == iterator) return;
+        auto const step = iterator->second.greet();
+        if (Peer::Step::Wait == step) return;
+        if ((Peer::Step::Close == step) || mSuccessor) return dismiss(descriptor);
+        Logger::instance() << "Successor connected, draining";
+        mSuccessor = ::std::move(iterator->second); mCandidates.erase(iterator);
+        remind();
+        mConnected();
+    }
+
+    inline auto Server::proceed() noexcept(false) -> void {
+        if (! mSuccessor.sent) return;
+        auto const step = mSuccessor.proceed();
+        if (Peer::Step::Wait == step) return;
+        if (Peer::Step::Done == step) { Logger::instance() << "Successor acknowledged handoff, leaving"; return mFinished(true); }
+        Logger::instance<Logger::Category::Error>() << "Successor left without acknowledgement, resuming";
+        forget(); mFinished(false);
+    }
+
+    inline auto Server::dismiss(int descriptor) noexcept(false) -> void { mReactor.remove(descriptor); mCandidates.erase(descriptor); }
+
+    inline auto Server::expire() noexcept(false) -> void {
+        if (0 == reactor::timer::read(mDeadline)) return;
+        auto const now = Peer::Clock::now();
+        for (auto iterator = mCandidates.begin(); mCandidates.end() != iterator;) {
+            auto const descriptor = iterator->first;
+            auto const expired = iterator->second.deadline <= now;
+            ++iterator;
+            if (expired) dismiss(descriptor);
+        }
+        if (mSuccessor.sent && (mSuccessor.deadline <= now)) {
+            Logger::instance<Logger::Category::Error>() << "Successor didn't acknowledge handoff in " << patience << " seconds, resuming";
+            forget(); return mFinished(false);
+        }
+        remind();
+    }
+
+    // one timer ends whichever greeting or acknowledgement stalls first
+    inline auto Server::remind() noexcept(false) -> void {
+        auto const now = Peer::Clock::now();
+        auto next = mSuccessor.sent ? mSuccessor.deadline : Peer::Clock::time_point::max();
+        for (auto const &candidate : mCandidates) next = ::std::min(next, candidate.second.deadline);
+        if (Peer::Clock::time_point::max() == next) return reactor::timer::arm(mDeadline, +0.0e+0);
+        reactor::timer::arm(mDeadline, ::std::max(::std::chrono::duration<double>{next - now}.count(), +1.0e-3));
+    }
+
+    // successor side: an invalid state means there is no predecessor to take over from; a predecessor
+    // that doesn't hand off within the drain time is an exception, and the caller starts cold
+    inline static auto receive() noexcept(false) {
+        auto &&session = Session{};
+        auto const address = makeAddress(path());
+        session.connection = Descriptor{::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0)};
+        if (! session.connection) throw PURE_CXX_POSIX_EXCEPTION_MAKE(::std::runtime_error{"handoff socket() failure: " + utils::errorCodeToString()});
+        if (0 != ::connect(session.connection.get(), reinterpret_cast<::sockaddr const *>(&address), sizeof(address))) {
+            auto const code = errno;
+            if ((ENOENT == code) || (ECONNREFUSED == code)) { session.connection.reset(); return ::std::move(session); }
+            throw PURE_CXX_POSIX_EXCEPTION_MAKE(::std::runtime_error{"handoff connect() failure: " + utils::errorCodeToString(code)});
+        }
+        timeout(session.connection, SO_RCVTIMEO, drain);
+        timeout(session.connection, SO_SNDTIMEO, patience);
+        writeAll(session.connection, hello(), ::std::strlen(hello()));
+
+        auto size = ::std::uint64_t{0};
+        auto descriptors = ::std::array<int, 2>{{-1, -1}};
+        alignas(::cmsghdr) char control[CMSG_SPACE(sizeof(descriptors))] = {};
+        auto vector = ::iovec{&size, sizeof(size)};
+        auto message = ::msghdr{};
+        message.msg_iov = &vector; message.msg_iovlen = 1;
+        message.msg_control = control; message.msg_controllen = sizeof(control);
+        auto const count = ::recvmsg(session.connection.get(), &message, MSG_CMSG_CLOEXEC | MSG_WAITALL);
+        if (static_cast<::ssize_t>(sizeof(size)) != count)
+            throw PURE_CXX_POSIX_EXCEPTION_MAKE(::std::runtime_error{"handoff recvmsg() failure: " + utils::errorCodeToString()});
+        auto const * const header = CMSG_FIRSTHDR(&message);
+        if (static_cast<bool>(header) && (SOL_SOCKET == header->cmsg_level) && (SCM_RIGHTS == header->cmsg_type) && (CMSG_LEN(sizeof(descriptors)) == header->cmsg_len)) {
+            ::std::memcpy(descriptors.data(), CMSG_DATA(header), sizeof(descriptors));
+            session.state.src = Descriptor{descriptors[0]};
+            session.state.dst = Descriptor{descriptors[1]};
+        }
+        if ((! session.state.src) || (! session.state.dst)) throw PURE_CXX_POSIX_EXCEPTION_MAKE(::std::runtime_error{"handoff descriptors are missing"});
+
+        auto &&blob = ::std::string(static_cast<::std::size_t>(size), '\0');
+        readAll(session.connection, &blob[0], blob.size());
+        deserialize(blob, session.state);
+        session.state.valid = true;
+        return ::std::move(session);
+    }
+
+    // acknowledges and blocks until the predecessor closes the connection on exit, at most the drain time
+    inline static auto acknowledge(Descriptor &connection) noexcept(false) {
+        auto const symbol = acknowledgement();
+        writeAll(connection, &symbol, 1);
+        for (auto buffer = char{0};;) {
+            auto const count = ::read(connection.get(), &buffer, 1);
+            if ((0 > count) && (EINTR == errno)) continue;
+            if (0 >= count) break;
+        }
+        connection.reset();
+    }
+
+} // namespace handoff
+} // namespace pure_cxx_posix
+
+#else
+#error "__cplusplus not defined. c++14 or hight is required"
+#endif // defined(__cplusplus) && (201402L <= __cplusplus)
+#endif // PURE_CXX_POSIX_HANDOFF_HPP
@@ -0,0 +1,176 @@
+#ifndef PURE_CXX_POSIX_LAYOUT_HPP
+#define PURE_CXX_POSIX_LAYOUT_HPP
+#pragma once
+#if defined(__cplusplus) && (201402L <= __cplusplus)
+
+#include <ctime>
+#include <cerrno>
+#include <cstdint>
+
+#include <list>
+#include <array>
+#include <memory>
+#include <string>
+#include <utility>
+#include <stdexcept>
+#include <system_error>
+#include <unordered_map>
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#include "shard.hpp"
+#include "config.hpp"
+#include "exception.hpp"
+#include "descriptor.hpp"
+#include "utils.hpp"
+
+
+namespace pure_cxx_posix {
+namespace layout {
+
+    using Kind = config::Type::Layout::Kind;
+    using Settings = config::Type::Layout;
+
+    // destination subdirectories opened on first use and kept open between scans, the least recently
+    // used one is closed when the cache is full; a cached handle is only checked when using it failed
+    struct Type final {
+        constexpr static ::std::size_t const maximum = 512;
+
+        // relative subdirectory for a name, empty for the flat layout
+        template <class T> inline auto subdirectory(T const &name) noexcept(false);
+
+        // handles stay valid while they are held, even after the cache let them go
+        using Handle = ::std::shared_ptr<Descriptor const>;
+
+        // handle of the subdirectory, created when missing; empty handle and code on failure
+        inline auto open(::std::string const &relative, ::std::error_code &code) noexcept(false) -> Handle;
+
+        // drops the cached handle of the subdirectory when its directory is unlinked, tells whether it did;
+        // for callers that failed to create a file in it
+        inline auto stale(::std::string const &relative) noexcept(true) -> bool;
+
+        inline auto device() const noexcept(true) { return mDevice; }
+
+        // called once per scan: keeps the cache while the destination and the settings stay the same
+        template <class T> inline auto prepare(T const &root, Settings const &settings) noexcept(false);
+
+    private:
+        Settings mSettings;
+        ::std::uint64_t mDevice = 0, mInode = 0;
+        ::std::size_t mCapacity = maximum;
+        // the root is never evicted, the rest of the handles are ordered from the most recently used
+        Handle mRoot;
+        ::std::list<::std::string> mOrder;
+        ::std::unordered_map<::std::string, ::std::pair<Handle, ::std::list<::std::string>::iterator>> mCache;
+
+        // every subdirectory of a hash layout fits when there are few enough of them
+        inline static auto capacity(Settings const &settings) noexcept(true) {
+            if (Kind::Hash != settings.kind) return maximum;
+            auto result = ::std::size_t{0}, level = ::std::size_t{1};
+            for (auto index = decltype(settings.depth){0}; (index < settings.depth) && (result < maximum); ++index) result += (level *= 256);
+            return (result < maximum) ? result : maximum;
+        }
+
+        ::std::time_t mSecond = -1;
+        ::std::string mDate;
+    };
+
+    template <class T> inline auto Type::subdirectory(T const &name) noexcept(false) {
+        auto &&result = ::std::string{};
+        if (Kind::Hash == mSettings.kind) {
+            constexpr static char const digits[] = "0123456789abcdef";
+            auto const value = shard::hash(name);
+            result.reserve(static_cast<::std::size_t>(mSettings.depth) * 3);
+            for (auto level = decltype(mSettings.depth){0}; level < mSettings.depth; ++level) {
+                auto const byte = static_cast<unsigned int>(value >> (56 - 8 * level)) & 0xff;
+                if (0 < level) result.push_back('/');
+                result.push_back(digits[byte >> 4]); result.push_back(digits[byte & 0xf]);
+            }
+        } else if (Kind::Date == mSettings.kind) {
+            auto const now = ::std::time(nullptr);
+            if (now != mSecond) {
+                auto time = ::tm{}; ::gmtime_r(&now, &time);
+                ::std::array<char, 256> buffer;
+                auto const size = ::std::strftime(buffer.data(), buffer.size(), mSettings.format.c_str(), &time);
+                mDate.assign(buffer.data(), size);
+                mSecond = now;
+            }
+            result = mDate;
+        }
+        return ::std::move(result);
+    }
+
+    inline auto Type::open(::std::string const &relative, ::std::error_code &code) noexcept(false) -> Handle {
+        if (relative.empty()) {
+            if (! mRoot) code = ::std::make_error_code(::std::errc::no_such_file_or_directory);
+            return mRoot;
+        }
+        auto const iterator = mCache.find(relative);
+        if (mCache.end() != iterator) { mOrder.splice(mOrder.begin(), mOrder, iterator->second.second); return iterator->second.first; }
+
+        auto const slash = relative.rfind('/');
+        auto const above = ::std::string::npos == slash ? ::std::string{} : relative.substr(0, slash);
+        auto const component = ::std::string::npos == slash ? relative : relative.substr(slash + 1);
+        if (component.empty() || ("." == component) || (".." == component)) { code = ::std::make_error_code(::std::errc::invalid_argument); return {}; }
+        auto const create = [&component] (int parent) {
+            auto &&descriptor = Descriptor{::openat(parent, component.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC)};
+            if ((! descriptor) && (ENOENT == errno) && ((0 == ::mkdirat(parent, component.c_str(), 0755)) || (EEXIST == errno))) {
+                descriptor.reset(::openat(parent, component.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC));
+            }
+            return ::std::move(descriptor);
+        };
+
+        auto parent = open(above, code);
+        if (! parent) return {};
+        auto &&descriptor = create(parent->get());
+        // a cached parent unlinked meanwhile fails with ENOENT, it is opened again once
+        if ((! descriptor) && (ENOENT == errno) && stale(above)) {
+            parent = open(above, code);
+            if (! parent) return {};
+            descriptor = create(parent->get());
+        }
+        if (! descriptor) { code.assign(errno, ::std::generic_category()); return {}; }
+
+        if (! (mCache.size() < mCapacity)) { mCache.erase(mOrder.back()); mOrder.pop_back(); }
+        mOrder.push_front(relative);
+        auto &&handle = ::std::make_shared<Descriptor const>(::std::move(descriptor));
+        mCache.emplace(relative, ::std::make_pair(handle, mOrder.begin()));
+        return ::std::move(handle);
+    }
+
+    inline auto Type::stale(::std::string const &relative) noexcept(true) -> bool {
+        auto const iterator = mCache.find(relative);
+        if (mCache.end() == iterator) return false;
+        struct ::stat information;
+        if ((0 == ::fstat(iterator->second.first->get(), &information)) && (0 < information.st_nlink)) return false;
+        mOrder.erase(iterator->second.second); mCache.erase(iterator);
+        return true;
+    }
+
+    template <class T> inline auto Type::prepare(T const &root, Settings const &settings) noexcept(false) {
+        auto &&descriptor = Descriptor{::open(root.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC)};
+        if (! descriptor) throw PURE_CXX_POSIX_EXCEPTION_MAKE(::std::runtime_error{"failed to open destination directory: " + utils::errorCodeToString()});
+        struct ::stat information;
+        if (0 != ::fstat(descriptor.get(), &information)) throw PURE_CXX_POSIX_EXCEPTION_MAKE(::std::runtime_error{
+            "failed to fstat() destination directory: " + utils::errorCodeToString()
+        });
+        auto const same = (mDevice == information.st_dev) && (mInode == information.st_ino) && (mSettings.kind == settings.kind)
+                       && (mSettings.depth == settings.depth) && (mSettings.format == settings.format);
+        if (same && mRoot) return;
+        mCache.clear(); mOrder.clear(); mSecond = -1;
+        mSettings = settings; mCapacity = capacity(settings); mDevice = information.st_dev; mInode = information.st_ino;
+        mRoot = ::std::make_shared<Descriptor const>(::std::move(descriptor));
+    }
+
+} // namespace layout
+
+    using Layout = layout::Type;
+
+} // namespace pure_cxx_posix
+
+#else
+#error "__cplusplus not defined. c++14 or hight is required"
+#endif // defined(__cplusplus) && (201402L <= __cplusplus)
+#endif // PURE_CXX_POSIX_LAYOUT_HPP
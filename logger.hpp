@@ -12,6 +12,7 @@
 #include <functional>
 #include <type_traits>
 
+#include "probe.hpp"
 #include "context.hpp"
 #include "utils.hpp"
 #include "not_object.hpp"
@@ -83,6 +84,7 @@ namespace logger {
             if (static_cast<bool>(sink)) try {
                 auto &&data = mBuffer->str();
                 if (data.empty()) return;
+                PURE_CXX_POSIX_PROBE(log__flush, data.size());
                 try { auto const l = utils::makeUniqueLock(Type::instance().mutex); utils::unused(l); sink(::std::move(data)); } catch(...) { sink = {}; }
             } catch(...) { mBuffer.reset(nullptr); }
             try { mBuffer->str({}); } catch(...) { mBuffer.reset(nullptr); }
@@ -4,19 +4,24 @@
 #include <cstring>
 #include <cstdint>
 
+#include <map>
+#include <array>
 #include <mutex>
+#include <atomic>
 #include <memory>
 #include <thread>
 #include <chrono>
 #include <ostream>
 #include <sstream>
+#include <vector>
 #include <utility>
+#include <iterator>
 #include <iostream>
+#include <algorithm>
 #include <exception>
 #include <stdexcept>
 #include <functional>
 #include <type_traits>
-#include <condition_variable>
 
 #include <signal.h>
 #include <syslog.h>
@@ -25,8 +30,31 @@
 #include <sys/types.h>
 
 #include "pid.hpp"
+#include "shard.hpp"
+#include "handoff.hpp"
 #include "logger.hpp"
+#include "devlog.hpp"
 #include "context.hpp"
+#include "poller.hpp"
+#include "engine.hpp"
+#include "mover.hpp"
+#include "backend.hpp"
+#include "packer.hpp"
+#include "space.hpp"
+#include "probe.hpp"
+#include "span.hpp"
+#include "stream.hpp"
+#include "layout.hpp"
+#include "pool.hpp"
+#include "walk.hpp"
+#include "tail.hpp"
+#include "backlog.hpp"
+#include "storm.hpp"
+#include "retry.hpp"
+#include "governor.hpp"
+#include "reactor.hpp"
+#include "control.hpp"
+#include "descriptor.hpp"
 #include "exception.hpp"
 #include "utils.hpp"
 #include "stdfs.hpp"
@@ -39,9 +67,20 @@ namespace pure_cxx_posix {
         if (bt.empty()) stream << "unknown exception caught";
         else if (0 < bt.back().second) {
             stream << "exception caught, backtrace [" << bt.rbegin()->second + 1 << "]:"; stream.flush();
-            for (auto const &item : bt) { stream << "  #" << item.second << ": " << exception::info::text(item.first); stream.flush(); }
+            auto &&frames = exception::Backtrace{};
+            for (auto const &item : bt) {
+                auto &&info = exception::info::make(item.first);
+                if (frames.empty()) frames = info.backtrace;
+                stream << "  #" << item.second << ": " << exception::info::text(::std::move(info)); stream.flush();
+            }
+            for (auto const &frame : exception::backtrace::symbolize(frames)) { stream << "    at " << frame; stream.flush(); }
+        }
+        else {
+            auto &&info = exception::info::make(bt.front().first);
+            auto const frames = info.backtrace;
+            stream << "exception caught: " << exception::info::text(::std::move(info)); stream.flush();
+            for (auto const &frame : exception::backtrace::symbolize(frames)) { stream << "    at " << frame; stream.flush(); }
         }
-        else stream << "exception caught: " << exception::info::text(bt.front().first);
     }
 
     template <class T> inline static auto printException(T &&stream) noexcept(false) {
@@ -59,126 +98,380 @@ namespace config {
         return stdfs::absolute((name.empty() ? ::std::string{utils::defaultName()} : ::std::move(name)) + ".conf", "/etc");
     }
 
-    inline static auto const read() noexcept(false) {
-        auto stream = ::std::ifstream{path(), ::std::ios_base::in};
-        stream.exceptions(stream.failbit | stream.badbit);
-        using Path = ::std::string; auto &&src = Path{}; auto &&dst = Path{};
-        using Delay = double; auto &&delay = ::std::numeric_limits<Delay>::quiet_NaN();
-        stream >> src; stream >> dst; stream >> delay;
-        if (src.empty()) throw PURE_CXX_POSIX_EXCEPTION_MAKE(::std::runtime_error{"invalid data"});
-        if (dst.empty()) throw PURE_CXX_POSIX_EXCEPTION_MAKE(::std::runtime_error{"invalid data"});
-        if (! (+1.0e+0 < delay)) throw PURE_CXX_POSIX_EXCEPTION_MAKE(::std::runtime_error{"invalid data"});
-        stream.close();
-        struct Result final { Path src, dst; Delay delay; };
-        return Result{::std::move(src), ::std::move(dst), ::std::move(delay)};
+    template <class T, class streamT, class keyT> inline static auto readValue(streamT &stream, keyT const &key) noexcept(false) {
+        auto &&value = T{};
+        if (! (stream >> value)) throw PURE_CXX_POSIX_EXCEPTION_MAKE(::std::runtime_error{"invalid value of " + key});
+        return ::std::move(value);
     }
 
-} // namespace config
-
-namespace daemon {
-
-    template <class T> inline static auto atomicWithContext(T &&action) {
-        auto &context = Context::instance();
-        auto const lock = utils::makeUniqueLock(context.mutex); utils::unused(lock); return action(context);
+    // one key with its value, the config file is a sequence of them
+    template <class streamT> inline static auto parse(::std::string const &key, streamT &stream, Config &result) noexcept(false) {
+        auto const profile = [&result] (auto const &key) -> auto & { return ('s' == key.front()) ? result.governor.scan : result.governor.copy; };
+        if ("poll.floor" == key) result.poll.floor = readValue<Config::Delay>(stream, key);
+        else if ("poll.ceiling" == key) result.poll.ceiling = readValue<Config::Delay>(stream, key);
+        else if ("shard.count" == key) result.shard.count = readValue<decltype(result.shard.count)>(stream, key);
+        else if ("include" == key) result.filter.include.push_back(readValue<::std::string>(stream, key));
+        else if ("exclude" == key) result.filter.exclude.push_back(readValue<::std::string>(stream, key));
+        else if ("recursive" == key) result.recursive = readValue<bool>(stream, key);
+        else if ("replica" == key) result.replicas.push_back(readValue<Config::Path>(stream, key));
+        else if ("backlog.memory" == key) result.backlog.memory = readValue<decltype(result.backlog.memory)>(stream, key);
+        else if ("cache.neutral" == key) result.cache.neutral = readValue<decltype(result.cache.neutral)>(stream, key);
+        else if ("space.low" == key) result.space.low = readValue<decltype(result.space.low)>(stream, key);
+        else if ("copy.method" == key) {
+            auto const value = readValue<::std::string>(stream, key);
+            result.copy.adaptive = "auto" == value;
+            if (! result.copy.adaptive) result.copy.method = strategy::parse(value);
+            if (strategy::Count == result.copy.method) throw PURE_CXX_POSIX_EXCEPTION_MAKE(::std::runtime_error{"invalid copy.method: " + value});
+        }
+        else if ("pack.size" == key) result.pack.size = readValue<decltype(result.pack.size)>(stream, key);
+        else if ("pack.segment" == key) result.pack.segment = readValue<decltype(result.pack.segment)>(stream, key);
+        else if ("pack.age" == key) result.pack.age = readValue<Config::Delay>(stream, key);
+        else if ("retry.base" == key) result.retry.base = readValue<Config::Delay>(stream, key);
+        else if ("retry.limit" == key) result.retry.limit = readValue<decltype(result.retry.limit)>(stream, key);
+        else if ("retry.quarantine" == key) result.retry.quarantine = readValue<Config::Path>(stream, key);
+        else if ("storm.threshold" == key) result.storm.threshold = readValue<decltype(result.storm.threshold)>(stream, key);
+        else if ("storm.pause" == key) result.storm.pause = readValue<Config::Delay>(stream, key);
+        else if ("storm.interval" == key) result.storm.interval = readValue<Config::Delay>(stream, key);
+        else if ("span.count" == key) result.span.count = readValue<decltype(result.span.count)>(stream, key);
+        else if ("threads" == key) result.threads = readValue<decltype(result.threads)>(stream, key);
+        else if (("scan.cpus" == key) || ("copy.cpus" == key)) { profile(key).cpus = readValue<::std::string>(stream, key); profile(key).given.cpus = true; }
+        else if (("scan.nice" == key) || ("copy.nice" == key)) { profile(key).nice = readValue<::std::int32_t>(stream, key); profile(key).given.nice = true; }
+        else if (("scan.idle" == key) || ("copy.idle" == key)) { profile(key).idle = readValue<bool>(stream, key); profile(key).given.idle = true; }
+        else if (("scan.io" == key) || ("copy.io" == key)) governor::io(readValue<::std::string>(stream, key), profile(key));
+        else if ("tail" == key) result.tail.enabled = readValue<bool>(stream, key);
+        else if ("tail.state" == key) result.tail.state = readValue<::std::string>(stream, key);
+        else if ("stream.timeout" == key) result.stream.timeout = readValue<Config::Delay>(stream, key);
+        else if ("layout" == key) {
+            auto const value = readValue<::std::string>(stream, key);
+            if ("flat" == value) result.layout.kind = Config::Layout::Kind::Flat;
+            else if ("hash" == value) result.layout.kind = Config::Layout::Kind::Hash;
+            else if ("date" == value) result.layout.kind = Config::Layout::Kind::Date;
+            else throw PURE_CXX_POSIX_EXCEPTION_MAKE(::std::runtime_error{"invalid layout: " + value});
+        }
+        else if ("layout.depth" == key) result.layout.depth = readValue<decltype(result.layout.depth)>(stream, key);
+        else if ("layout.format" == key) result.layout.format = readValue<::std::string>(stream, key);
+        else throw PURE_CXX_POSIX_EXCEPTION_MAKE(::std::runtime_error{"unknown key: " + key});
     }
 
-    inline static auto signalHandler(int id) noexcept(true) {
-        switch (id) {
-        default:
-            Logger::instance() << "Unknown signal [" << id << "] caught";
-            break;
+    inline static auto validate(Config &result) noexcept(false) {
+        if (! (+0.0e+0 < result.poll.floor)) throw PURE_CXX_POSIX_EXCEPTION_MAKE(::std::runtime_error{"invalid poll.floor"});
+        if (! (result.poll.floor <= result.poll.ceiling)) throw PURE_CXX_POSIX_EXCEPTION_MAKE(::std::runtime_error{"invalid poll.ceiling"});
+        if (0 > result.shard.count) throw PURE_CXX_POSIX_EXCEPTION_MAKE(::std::runtime_error{"invalid shard.count"});
+        if ((! result.filter.compiled) && (! (result.filter.include.empty() && result.filter.exclude.empty()))) {
+            result.filter.compiled = ::std::make_shared<Filter>(result.filter.include, result.filter.exclude);
+        }
+        for (auto const *profile : {&result.governor.scan, &result.governor.copy}) {
+            if ((-20 > profile->nice) || (19 < profile->nice)) throw PURE_CXX_POSIX_EXCEPTION_MAKE(::std::runtime_error{"invalid nice value"});
+            governor::cpus(profile->cpus);
+        }
+        if (result.tail.enabled && stream::remote(result.dst)) throw PURE_CXX_POSIX_EXCEPTION_MAKE(::std::runtime_error{"tail needs a directory destination"});
+        if (! (+0.0e+0 < result.stream.timeout)) throw PURE_CXX_POSIX_EXCEPTION_MAKE(::std::runtime_error{"invalid stream.timeout"});
+        if ((1 > result.threads) || (256 < result.threads)) throw PURE_CXX_POSIX_EXCEPTION_MAKE(::std::runtime_error{"invalid threads"});
+        if (! (result.replicas.size() < engine::replicas)) throw PURE_CXX_POSIX_EXCEPTION_MAKE(::std::runtime_error{"too many replicas"});
+        if ((! result.replicas.empty()) && stream::remote(result.dst)) throw PURE_CXX_POSIX_EXCEPTION_MAKE(::std::runtime_error{"replicas require a directory destination"});
+        if ((! result.replicas.empty()) && result.tail.enabled) throw PURE_CXX_POSIX_EXCEPTION_MAKE(::std::runtime_error{"replicas are not available in tail mode"});
+        if ((1 > result.backlog.memory) || (4096 < result.backlog.memory)) throw PURE_CXX_POSIX_EXCEPTION_MAKE(::std::runtime_error{"invalid backlog.memory"});
+        if (0 > result.cache.neutral) throw PURE_CXX_POSIX_EXCEPTION_MAKE(::std::runtime_error{"invalid cache.neutral"});
+        if (0 > result.space.low) throw PURE_CXX_POSIX_EXCEPTION_MAKE(::std::runtime_error{"invalid space.low"});
+        if ((0 > result.pack.size) || (0x1000000 < result.pack.size)) throw PURE_CXX_POSIX_EXCEPTION_MAKE(::std::runtime_error{"invalid pack.size"});
+        if ((1 > result.pack.segment) || (4096 < result.pack.segment)) throw PURE_CXX_POSIX_EXCEPTION_MAKE(::std::runtime_error{"invalid pack.segment"});
+        if (! (+0.0e+0 < result.pack.age)) throw PURE_CXX_POSIX_EXCEPTION_MAKE(::std::runtime_error{"invalid pack.age"});
+        if ((0 < result.pack.size) && (stream::remote(result.dst) || (! result.replicas.empty()) || result.tail.enabled)) {
+            throw PURE_CXX_POSIX_EXCEPTION_MAKE(::std::runtime_error{"pack.size needs a directory destination without replicas and tail"});
+        }
+        if (! (+0.0e+0 < result.retry.base)) throw PURE_CXX_POSIX_EXCEPTION_MAKE(::std::runtime_error{"invalid retry.base"});
+        if (0 > result.retry.limit) throw PURE_CXX_POSIX_EXCEPTION_MAKE(::std::runtime_error{"invalid retry.limit"});
+        if (0 > result.storm.threshold) throw PURE_CXX_POSIX_EXCEPTION_MAKE(::std::runtime_error{"invalid storm.threshold"});
+        if (! (+0.0e+0 < result.storm.pause)) throw PURE_CXX_POSIX_EXCEPTION_MAKE(::std::runtime_error{"invalid storm.pause"});
+        if (! (+0.0e+0 < result.storm.interval)) throw PURE_CXX_POSIX_EXCEPTION_MAKE(::std::runtime_error{"invalid storm.interval"});
+        if ((0 > result.span.count) || (1024 < result.span.count)) throw PURE_CXX_POSIX_EXCEPTION_MAKE(::std::runtime_error{"invalid span.count"});
+        if ((1 > result.layout.depth) || (8 < result.layout.depth)) throw PURE_CXX_POSIX_EXCEPTION_MAKE(::std::runtime_error{"invalid layout.depth"});
+        if (result.layout.format.empty() || ('/' == result.layout.format.front())) throw PURE_CXX_POSIX_EXCEPTION_MAKE(::std::runtime_error{"invalid layout.format"});
+    }
 
-        case SIGTERM:
-            Logger::instance() << "SIGTERM caught";
-            return atomicWithContext([] (auto &&context) { context.condition = false; context.event.notify_all(); });
+    inline static auto read() noexcept(false) {
+        auto stream = ::std::ifstream{path(), ::std::ios_base::in};
+        stream.exceptions(stream.failbit | stream.badbit);
+        auto &&result = Config{}; result.delay = ::std::numeric_limits<Config::Delay>::quiet_NaN();
+        stream >> result.src; stream >> result.dst; stream >> result.delay;
+        if (result.src.empty()) throw PURE_CXX_POSIX_EXCEPTION_MAKE(::std::runtime_error{"invalid data"});
+        if (result.dst.empty()) throw PURE_CXX_POSIX_EXCEPTION_MAKE(::std::runtime_error{"invalid data"});
+        if (! (+1.0e+0 < result.delay)) throw PURE_CXX_POSIX_EXCEPTION_MAKE(::std::runtime_error{"invalid data"});
+        result.poll.floor = result.poll.ceiling = result.delay;
+
+        stream.exceptions(stream.badbit);
+        for (auto &&key = ::std::string{}; stream >> key;) parse(key, stream, result);
+        validate(result);
+        stream.close();
+        return ::std::move(result);
+    }
 
-        case SIGHUP:
-            Logger::instance() << "SIGHUP caught";
-            return atomicWithContext([] (auto &&context) { context.interrupt = true; context.event.notify_all(); });
+    // a copy of current with one key changed, only keys that take effect on the next scan
+    // are adjustable, the others need the config file and SIGHUP
+    inline static auto adjust(Config const &current, ::std::string const &line) noexcept(false) {
+        static char const * const adjustable[] = {
+            "poll.floor", "poll.ceiling", "threads", "backlog.memory", "cache.neutral", "space.low", "copy.method", "span.count",
+            "retry.base", "retry.limit", "storm.threshold", "storm.pause", "storm.interval"
+        };
+        auto &&result = Config{current};
+        auto stream = ::std::istringstream{line};
+        auto &&key = ::std::string{}; stream >> key;
+        if (::std::end(adjustable) == ::std::find(::std::begin(adjustable), ::std::end(adjustable), key)) {
+            throw PURE_CXX_POSIX_EXCEPTION_MAKE(::std::invalid_argument{"not adjustable at runtime: " + key});
         }
+        parse(key, stream, result);
+        if (! (stream >> ::std::ws).eof()) throw PURE_CXX_POSIX_EXCEPTION_MAKE(::std::invalid_argument{"trailing data after " + key});
+        validate(result);
+        return ::std::move(result);
     }
 
-    template <class srcT, class dstT> inline static auto moveFiles(srcT &&src, dstT &&dst) noexcept(false) {
-        if (src.empty()) throw PURE_CXX_POSIX_EXCEPTION_MAKE(::std::invalid_argument{"source directory path is empty"});
-        if (dst.empty()) throw PURE_CXX_POSIX_EXCEPTION_MAKE(::std::invalid_argument{"destination directory path is empty"});
-        Logger::instance() << "Moving files from " << src << " to " << dst << "...";
-
-        auto const srcPath = stdfs::path{::std::forward<srcT>(src)};
-        if (! stdfs::exists(srcPath)) throw PURE_CXX_POSIX_EXCEPTION_MAKE(::std::invalid_argument{"source directory is not exists"});
-        if (! stdfs::is_directory(srcPath)) throw PURE_CXX_POSIX_EXCEPTION_MAKE(::std::invalid_argument{"source is not directory"});
+    // a copy of current changed by the interval or set command of the control socket: a fixed interval
+    // is the delay with both poll bounds at it, like a config without poll.* keys
+    inline static auto command(Config const &current, ::std::string const &name, ::std::string const &rest) noexcept(false) {
+        if ("set" == name) return adjust(current, rest);
+        auto &&result = Config{current};
+        auto values = ::std::istringstream{rest};
+        auto const delay = readValue<Config::Delay>(values, name);
+        if (! (+1.0e+0 < delay)) throw PURE_CXX_POSIX_EXCEPTION_MAKE(::std::invalid_argument{"interval has to be over a second"});
+        result.delay = result.poll.floor = result.poll.ceiling = delay;
+        return ::std::move(result);
+    }
 
-        auto const dstPath = stdfs::path{::std::forward<dstT>(dst)};
-        if (! stdfs::exists(dstPath)) throw PURE_CXX_POSIX_EXCEPTION_MAKE(::std::invalid_argument{"destination directory is not exists"});
-        if (! stdfs::is_directory(dstPath)) throw PURE_CXX_POSIX_EXCEPTION_MAKE(::std::invalid_argument{"destination is not directory"});
+} // namespace config
 
-        auto flag = true;
-        auto &context = Context::instance();
+namespace daemon {
 
-        while(true) {
-            context.mutex.lock();
-            flag = (! context.condition) || context.interrupt;
-            context.mutex.unlock();
-            if (flag) break;
-            flag = true;
-
-            for (auto const &item : stdfs::directory_iterator{srcPath}) try {
-                if (! stdfs::is_regular_file(item)) continue;
-                auto const relative = stdfs::path{item}.filename();
-                if (relative.empty()) throw PURE_CXX_POSIX_EXCEPTION_MAKE(::std::invalid_argument{"empty relative path"});
-                auto const src = stdfs::absolute(relative, srcPath);
-                auto const dst = stdfs::absolute(relative, dstPath);
-                Logger::instance() << "Moving " << src << " to " << dst << "...";
-                try { errno = 0; stdfs::copy_file(src, dst, stdfs::copy_options::overwrite_existing); stdfs::remove(src); }
-                catch(...) { throw PURE_CXX_POSIX_EXCEPTION_MAKE_FROM_CURRENT(::std::runtime_error{
-                    "failed to move src " + ::std::string{src} + " to " + ::std::string{dst}
-                }); };
-                flag = false; break;
-            } catch (...) { printException(); }
-
-            if (flag) break;
-        }
+    inline static auto layoutName(Config::Layout const &layout) noexcept(false) {
+        if (Config::Layout::Kind::Hash == layout.kind) return "hash/" + ::std::to_string(layout.depth);
+        if (Config::Layout::Kind::Date == layout.kind) return "date/" + layout.format;
+        return ::std::string{"flat"};
     }
 
-    inline static auto applyConfig() noexcept(true) {
+    // shards are locked once at start, a reload keeps their count: running is it, negative before start
+    inline static auto applyConfig(shard::Index running = -1) noexcept(true) {
         auto &logger = Logger::instance();
         auto &context = Context::instance();
         try {
             logger << "Reading config now...";
-            auto const &&data = config::read();
-            context.src = ::std::move(data.src);
-            context.dst = ::std::move(data.dst);
-            context.delay = ::std::move(data.delay);
+            auto &&fresh = config::read();
+            if ((0 <= running) && (running != fresh.shard.count)) {
+                Logger::instance<Logger::Category::Error>() << "shard.count can't change without a restart, keeping " << running << " shards";
+                fresh.shard.count = running;
+            }
+            context.config.publish(::std::move(fresh));
         } catch(...) { printException(Logger::instance<Logger::Category::Error>().makeScope() << "Failed to load config: "); }
 
-        logger << "My current settings: src = " << context.src << ", dst = " << context.dst << ", delay = " << context.delay;
+        auto const config = context.config.read();
+        try { context.spans.resize(static_cast<::std::size_t>(config->span.count)); } catch(...) { printException(); }
+        logger << "My current settings: src = " << config->src << ", dst = " << config->dst << ", delay = " << config->delay
+               << ", poll = [" << config->poll.floor << ", " << config->poll.ceiling << "], shards = " << config->shard.count
+               << ", layout = " << layoutName(config->layout) << ", recursive = " << config->recursive << ", tail = " << config->tail.enabled << ", threads = " << config->threads << ", spans = " << config->span.count
+               << ", storm = [" << config->storm.threshold << ", " << config->storm.pause << ", " << config->storm.interval << "]"
+               << ", filters = " << config->filter.include.size() << " include, " << config->filter.exclude.size() << " exclude"
+               << ", scan = " << governor::describe(config->governor.scan) << ", copy = " << governor::describe(config->governor.copy);
     }
 
-    inline static auto loop() noexcept(false) {
-        Logger::instance() << "My config path is: " << config::path();
+    // the slowest moves since the previous report, slowest first, durations in microseconds
+    inline static auto reportSpans() noexcept(true) {
+        auto &spans = Context::instance().spans;
+        if (! spans.enabled()) { Logger::instance() << "Span recording is off, set span.count to enable it"; return; }
+        try {
+            auto const taken = spans.take();
+            Logger::instance() << "Slowest " << taken.size() << " moves since the previous report:";
+            for (auto const &span : taken) {
+                auto &&scope = Logger::instance().makeScope();
+                scope << span.name << ": " << span.total / 1000 << " us [";
+                for (auto stage = ::std::size_t{0}; stage < span::Count; ++stage) {
+                    scope << (0 == stage ? "" : ", ") << span::label(static_cast<span::Stage>(stage)) << " " << span.stages[stage] / 1000;
+                }
+                scope << "]";
+                if (nullptr != span.failure) scope << ", failed at " << span.failure;
+            }
+        } catch(...) { printException(); }
+    }
 
-        applyConfig();
+    inline static auto loop(Descriptor const &signals, Shards &shards, handoff::State &&inherited) noexcept(false) {
         auto &context = Context::instance();
-        auto lock = utils::makeUniqueLock(context.mutex);
-
-        while (context.condition) {
-            auto const moment = ::std::chrono::steady_clock::now() + utils::makeSeconds(context.delay);
-            while (context.condition) {
-                context.event.wait_until(lock, moment);
-                if (context.interrupt) { context.interrupt = false; applyConfig(); break; }
-                if (moment <= ::std::chrono::steady_clock::now()) {
-                    auto pair = ::std::make_pair(context.src, context.dst);
-                    lock.unlock();
-                    try { moveFiles(::std::move(pair.first), ::std::move(pair.second)); } catch(...) { printException(); }
-                    lock.lock();
-                    break;
-                }
+
+        Reactor eventLoop;
+        auto const timer = reactor::timer::make();
+        auto const completion = reactor::event::make();
+        auto worker = ::std::thread{};
+
+        auto &&route = mover::Route{};
+        auto &&outcome = mover::Scan{};
+        auto reported = false, held = false, rescan = false;
+        auto pause = +0.0e+0;
+        route.pending = ::std::move(inherited.pending);
+
+        auto const restart = [&route, &context, &reported] () {
+            auto const config = context.config.read();
+            reported = false;
+            route.poller.reset(::std::min(::std::max(config->delay, config->poll.floor), config->poll.ceiling));
+        };
+
+        auto const schedule = [&timer, &route, &held] () { reactor::timer::arm(timer, held ? +0.0e+0 : route.poller.interval); };
+
+        // a successor drains the route, the scan in flight stops after its current file and the state goes out then
+        auto &&successor = ::std::unique_ptr<handoff::Server>{};
+        auto const resume = [&] () {
+            successor->forget();
+            route.pending.clear(); route.poller.end(false);
+            context.drain = false;
+            schedule();
+        };
+        auto const transfer = [&] () {
+            try {
+                auto &&state = handoff::State{};
+                auto const config = context.config.read();
+                state.interval = route.poller.interval;
+                state.stamp = route.pending.empty() ? route.poller.stamp() : route.poller.pending();
+                state.pending = ::std::move(route.pending);
+                state.src = handoff::openPath(config->src);
+                state.dst = handoff::openPath(stream::remote(config->dst) ? stream::address(config->dst) : config->dst);
+                successor->send(state);
+            } catch(...) {
+                printException(Logger::instance<Logger::Category::Error>().makeScope() << "Handoff failed, resuming: ");
+                resume();
+            }
+        };
+        successor.reset(new handoff::Server{eventLoop, [&shards] () {
+            if (0 < shards.count()) return Descriptor{};
+            try { return handoff::listen(); } catch(...) { printException(Logger::instance<Logger::Category::Error>().makeScope() << "Handoff is unavailable: "); }
+            return Descriptor{};
+        } (), [&] () {
+            context.drain = true;
+            reactor::timer::arm(timer, +0.0e+0);
+            if (! worker.joinable()) transfer();
+        }, [&] (bool acknowledged) {
+            if (! acknowledged) return resume();
+            context.condition = false;
+            eventLoop.stop();
+        }});
+
+        auto &&commands = control::Commands{};
+        auto const idle = [&] () { return (! worker.joinable()) && (! *successor); };
+        commands.scan = [&] () {
+            if (held) return control::Scan::Paused;
+            if (! idle()) { rescan = true; return control::Scan::Queued; }
+            route.poller.invalidate(); pause = +0.0e+0;
+            reactor::timer::arm(timer, +1.0e-3);
+            return control::Scan::Started;
+        };
+        commands.pause = [&] () {
+            held = true; context.hold = true;
+            reactor::timer::arm(timer, +0.0e+0);
+        };
+        commands.resume = [&] () {
+            if (! ::std::exchange(held, false)) return;
+            context.hold = false;
+            if (idle()) reactor::timer::arm(timer, +1.0e-3);
+        };
+        commands.adjust = [&] (::std::string const &name, ::std::string const &rest) {
+            context.config.update([&name, &rest] (Config &config) { config = config::command(config, name, rest); });
+            context.spans.resize(static_cast<::std::size_t>(context.config.read()->span.count));
+            Logger::instance() << "Control: " << name << " " << rest;
+            if (idle() && (! held)) { restart(); schedule(); }
+        };
+        commands.stats = [&] () {
+            auto &&stats = control::Stats{};
+            stats.state = held ? "paused" : *successor ? "draining" : worker.joinable() ? "moving" : (+0.0e+0 < pause) ? "storm" : "idle";
+            stats.interval = route.poller.interval;
+            stats.queued = idle() ? route.pending.size() : context.counters.queued.load(::std::memory_order_relaxed);
+            stats.retrying = route.retries.size();
+            stats.streak = static_cast<::std::size_t>(route.storm.streak());
+            stats.threads = static_cast<::std::size_t>(context.config.read()->threads);
+            stats.free = route.space.available();
+            stats.copies = route.strategies.describe();
+            return ::std::move(stats);
+        };
+        auto &&server = control::Server{eventLoop, [&shards] () {
+            try { return control::listen(0 < shards.count()); } catch(...) { printException(Logger::instance<Logger::Category::Error>().makeScope() << "Control socket is unavailable: "); }
+            return control::Listener{};
+        } (), ::std::move(commands)};
+        utils::unused(server);
+
+        eventLoop.add(signals.get(), EPOLLIN, [&] (auto) {
+            while (auto const id = reactor::signals::read(signals)) switch (id) {
+            default:
+                Logger::instance() << "Unknown signal [" << id << "] caught";
+                break;
+
+            case SIGTERM:
+                Logger::instance() << "SIGTERM caught";
+                context.condition = false;
+                if (! worker.joinable()) eventLoop.stop();
+                break;
+
+            case SIGUSR1:
+                reportSpans();
+                break;
+
+            case SIGHUP:
+                Logger::instance() << "SIGHUP caught";
+                context.interrupt = true;
+                if (! idle()) break;
+                context.interrupt = false; applyConfig(shards.count()); restart(); schedule();
+                break;
             }
+        });
+
+        eventLoop.add(timer.get(), EPOLLIN, [&] (auto) {
+            if ((0 == reactor::timer::read(timer)) || (! idle()) || held) return;
+            auto const config = context.config.read();
+            worker = ::std::thread{[&] (auto const settings, auto const report) {
+                // repeated scan failures are reported in full once per storm.interval, like the per-file ones
+                auto const failure = [&route, &settings] (storm::Key &&key) { if (route.storm.admit(::std::move(key), "scan", settings.storm.interval)) printException(); };
+                outcome = mover::Scan{};
+                try { outcome = mover::scan(route, shards, settings, report); }
+                catch (exception::Type const &error) { failure(storm::site(error.context)); }
+                catch (::std::system_error const &error) { failure(storm::Key{error.code().value(), error.what()}); }
+                catch(...) { printException(); }
+                // a segment is sealed by age on quiet ticks too
+                try { route.packer.commit(); } catch(...) { printException(); }
+                try { mover::summarize(route.storm, settings.storm.interval); } catch(...) { printException(); }
+                shards.release();
+                reactor::event::notify(completion);
+            }, Config{*config}, ! ::std::exchange(reported, true)};
+        });
+
+        eventLoop.add(completion.get(), EPOLLIN, [&] (auto) {
+            if (0 == reactor::event::read(completion)) return;
+            worker.join();
+            if (! context.condition) return eventLoop.stop();
+            if (*successor) return transfer();
+            if (context.interrupt.exchange(false)) { applyConfig(shards.count()); restart(); }
+            else { auto const config = context.config.read(); route.poller.adapt(outcome.active, config->poll.floor, config->poll.ceiling); }
+            if (held) return;
+            // a scan asked for while this one ran starts right away, past the stat gate
+            if (::std::exchange(rescan, false)) { route.poller.invalidate(); pause = +0.0e+0; return reactor::timer::arm(timer, +1.0e-3); }
+            // a paused route is probed again after the pause, which doubles while the storm lasts
+            if (! outcome.paused) { pause = +0.0e+0; return schedule(); }
+            auto const config = context.config.read();
+            pause = ::std::min((+0.0e+0 < pause) ? pause * +2.0e+0 : config->storm.pause, config->storm.pause * +1.6e+1);
+            Logger::instance() << "Route is paused for " << pause << " seconds";
+            reactor::timer::arm(timer, pause);
+        });
+
+        restart();
+        if (inherited.valid) {
+            auto const config = context.config.read();
+            route.poller.interval = ::std::min(::std::max(inherited.interval, config->poll.floor), config->poll.ceiling);
+            route.poller.inherit(inherited.stamp, ! route.pending.empty());
+        }
+        if (route.pending.empty()) schedule(); else reactor::timer::arm(timer, +1.0e-3);
+
+        try { eventLoop.run(); } catch(...) {
+            context.condition = false;
+            if (worker.joinable()) worker.join();
+            throw;
         }
+        route.packer.seal();
     }
 
     inline static auto main() noexcept(false) {
-        Logger::instance<Logger::Category::Info>().sink = [] (auto &&message) { ::syslog(LOG_INFO, "[INFO] %s", message.c_str()); };
-        Logger::instance<Logger::Category::Error>().sink = [] (auto &&message) { ::syslog(LOG_ERR, "[ERROR] %s", message.c_str()); };
+        Logger::instance<Logger::Category::Info>().sink = devlog::instance().sink(LOG_INFO, "[INFO] ");
+        Logger::instance<Logger::Category::Error>().sink = devlog::instance().sink(LOG_ERR, "[ERROR] ");
         Logger::instance() << "Hello, world!" << " This is child process";
 
         if (0 != ::close(STDIN_FILENO)) throw PURE_CXX_POSIX_EXCEPTION_MAKE(::std::runtime_error{"STDIN close() failure: " + utils::errorCodeToString()});
@@ -186,11 +479,42 @@ namespace daemon {
         if (0 != ::close(STDERR_FILENO)) throw PURE_CXX_POSIX_EXCEPTION_MAKE(::std::runtime_error{"STDERR close() failure: " + utils::errorCodeToString()});
         Logger::instance() << "STDIN, STDOUT, STDERR closed";
 
-        if (SIG_ERR == ::signal(SIGHUP, signalHandler))
-            throw PURE_CXX_POSIX_EXCEPTION_MAKE(::std::runtime_error{"SIGHUP handler activation failure: " + utils::errorCodeToString()});
-        if (SIG_ERR == ::signal(SIGTERM, signalHandler))
-            throw PURE_CXX_POSIX_EXCEPTION_MAKE(::std::runtime_error{"SIGTERM handler activation failure: " + utils::errorCodeToString()});
-        Logger::instance() << "SIGHUP, SIGTERM handler activated";
+        auto const signals = [] () { try { return reactor::signals::make({SIGHUP, SIGTERM, SIGUSR1}); } catch(...) {
+            throw PURE_CXX_POSIX_EXCEPTION_MAKE_FROM_CURRENT(::std::runtime_error{"SIGHUP, SIGTERM, SIGUSR1 signalfd activation failure"});
+        } } ();
+        Logger::instance() << "SIGHUP, SIGTERM, SIGUSR1 signalfd activated";
+
+        Logger::instance() << "My config path is: " << config::path();
+        applyConfig();
+
+        auto &&shards = Shards{Context::instance().config.read()->shard.count};
+        auto &&inherited = handoff::State{};
+        if (0 < shards.count()) {
+            Logger::instance() << "Sharded mode, " << shards.count() << " shards";
+            try { shards.acquire(); shards.release(); } catch(...) {
+                throw PURE_CXX_POSIX_EXCEPTION_MAKE_FROM_CURRENT(::std::runtime_error{"failed to lock shard"});
+            }
+            Logger::instance() << "Hello, Hell! I'm daemon now. =p";
+            Logger::instance() << "My pid: " << ::getpid();
+            if (0 > shards.primary()) Logger::instance() << "All shards are busy, i'm standby until one is orphaned";
+            else Logger::instance() << "My shard file: " << shard::path(shards.primary());
+            try { loop(signals, shards, ::std::move(inherited)); } catch(...) { throw PURE_CXX_POSIX_EXCEPTION_MAKE_FROM_CURRENT(::std::runtime_error{"loop failed"}); }
+            return;
+        }
+
+        try {
+            auto &&session = handoff::receive();
+            if (session.state.valid) {
+                Logger::instance() << "Predecessor found, it handed off " << session.state.pending.size() << " pending files";
+                auto const config = Context::instance().config.read();
+                if ((! handoff::matches(session.state.src, config->src)) || (! handoff::matches(session.state.dst, stream::remote(config->dst) ? stream::address(config->dst) : config->dst))) {
+                    Logger::instance() << "Predecessor directories differ from mine, dropping its state";
+                    session.state = handoff::State{};
+                }
+                handoff::acknowledge(session.connection);
+                inherited = ::std::move(session.state);
+            }
+        } catch(...) { printException(Logger::instance<Logger::Category::Error>().makeScope() << "Handoff failed, starting cold: "); }
 
         auto const lock = [] () { try { return pid::lock(); } catch(...) {
             throw PURE_CXX_POSIX_EXCEPTION_MAKE_FROM_CURRENT(::std::runtime_error{"failed to lock pidflie"});
@@ -200,7 +524,7 @@ namespace daemon {
         Logger::instance() << "My pid: " << lock.pid;
         Logger::instance() << "My pidfile: " << lock.path;
 
-        try { loop(); } catch(...) { throw PURE_CXX_POSIX_EXCEPTION_MAKE_FROM_CURRENT(::std::runtime_error{"loop failed"}); }
+        try { loop(signals, shards, ::std::move(inherited)); } catch(...) { throw PURE_CXX_POSIX_EXCEPTION_MAKE_FROM_CURRENT(::std::runtime_error{"loop failed"}); }
     }
 
 } // namespace daemon
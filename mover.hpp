@@ -0,0 +1,272 @@
+#ifndef PURE_CXX_POSIX_MOVER_HPP
+#define PURE_CXX_POSIX_MOVER_HPP
+#pragma once
+#if defined(__cplusplus) && (201402L <= __cplusplus)
+
+#include <mutex>
+#include <atomic>
+#include <memory>
+#include <string>
+#include <vector>
+#include <utility>
+#include <iterator>
+#include <algorithm>
+#include <system_error>
+
+#include "pool.hpp"
+#include "span.hpp"
+#include "tail.hpp"
+#include "walk.hpp"
+#include "probe.hpp"
+#include "shard.hpp"
+#include "space.hpp"
+#include "storm.hpp"
+#include "retry.hpp"
+#include "config.hpp"
+#include "layout.hpp"
+#include "logger.hpp"
+#include "packer.hpp"
+#include "poller.hpp"
+#include "stream.hpp"
+#include "backend.hpp"
+#include "backlog.hpp"
+#include "context.hpp"
+#include "governor.hpp"
+#include "strategy.hpp"
+#include "utils.hpp"
+#include "stdfs.hpp"
+
+
+namespace pure_cxx_posix {
+namespace mover {
+
+    // true when a scan has to stop between files: shutdown, reload, drain or a pause from the control socket
+    inline static auto stopped() noexcept(true) {
+        auto const &context = Context::instance();
+        return (! context.condition.load(::std::memory_order_acquire)) || context.interrupt.load(::std::memory_order_acquire)
+            || context.drain.load(::std::memory_order_acquire) || context.hold.load(::std::memory_order_acquire);
+    }
+
+    struct Result final {
+        ::std::size_t moved = 0, failed = 0, deferred = 0;
+        bool complete = true, paused = false;
+        Backlog pending;
+    };
+
+    // moves names through the backend (see backend.hpp) with config.threads threads, stops between files on shutdown,
+    // reload, drain, pause or an error storm, names left unprocessed are returned as pending; a scan may take
+    // several runs, so forgetting failures of files no longer listed (Retry::sweep) is up to the caller
+    template <class backendT> inline static auto run(backendT &backend, Storm &storm, Retry &retries, Config const &config, Backlog names, bool report) noexcept(false) {
+        backend.prepare(config);
+
+        auto &&result = Result{};
+        ::std::atomic<::std::size_t> moved{0}, failed{0}, deferred{0};
+        ::std::atomic<bool> full{false};
+        ::std::mutex mutex;
+
+        // a streak of identical failures means the destination is broken as a whole, not the files
+        auto const threshold = static_cast<::std::size_t>(config.storm.threshold);
+        auto const storming = [&storm, threshold] () { return (0 < threshold) && (threshold <= storm.streak()); };
+
+        // a file that failed retry.limit times in a row is moved aside, or skipped until it changes
+        auto const quarantine = [&config, &backend] (auto const &name) {
+            auto const src = backend.source(name);
+            if (config.retry.quarantine.empty()) { Logger::instance<Logger::Category::Error>() << "Giving up on " << src << " until it changes"; return; }
+            auto const directory = stdfs::path{config.retry.quarantine};
+            if (backend.quarantine(name, directory)) { Logger::instance<Logger::Category::Error>() << "Quarantined " << src << " to " << directory / name; return; }
+            Logger::instance<Logger::Category::Error>() << "Failed to quarantine " << src << " to " << directory / name << ": " << utils::errorCodeToString() << ", skipping it until it changes";
+        };
+
+        // the slowest moves are kept with their stage durations when span.count is set
+        auto &spans = Context::instance().spans;
+        auto const moveOne = [&] (auto &name, auto thread) {
+            if (name.empty()) { ++failed; Logger::instance<Logger::Category::Error>() << "Failed to move: empty relative path"; return; }
+            auto const identify = [&backend, &name] (retry::Identity &identity) { return backend.identify(name, identity); };
+            if (retry::Verdict::Defer == retries.verdict(name, identify)) { ++deferred; return; }
+            auto &&span = Span{spans.enabled()};
+            auto const status = backend.transfer(name, thread, span);
+            PURE_CXX_POSIX_PROBE(move__done, name.c_str(), status.code.value(), status.operation);
+            // a full destination pauses the route, the file stays for a later scan without counting as failed;
+            // a file larger than what is left above space.low waits for its retry while the smaller ones go on
+            if (status.full() && (! backend.exhausted())) {
+                ++deferred;
+                Logger::instance() << "Deferring " << backend.source(name) << ", it doesn't fit in " << backend.destination() << " now";
+                retries.failed(name, identify, config.retry.base, 0);
+                return;
+            }
+            if (status.full()) {
+                full = true;
+                auto const lock = utils::makeUniqueLock(mutex); utils::unused(lock);
+                result.complete = false; result.paused = true;
+                result.pending.push(name);
+                return;
+            }
+            if (! status.failed()) { ++moved; storm.success(); retries.succeeded(name); }
+            else {
+                ++failed;
+                if (storm.admit(storm::classify(status), name, config.storm.interval)) {
+                    Logger::instance<Logger::Category::Error>() << "Failed to move " << backend.source(name) << " to " << backend.destination() << ": " << status.operation << ": " << status.code.message();
+                }
+                // failures of a storm belong to the route, they don't count against the files
+                if ((! storming()) && (retry::Verdict::Quarantine == retries.failed(name, identify, config.retry.base, static_cast<::std::size_t>(config.retry.limit)))) quarantine(name);
+            }
+            if (! span.enabled()) return;
+            span.finish(status.failed() ? status.operation : nullptr);
+            span.name = name;
+            spans.record(::std::move(span));
+        };
+
+        // chunks of names are the unit of stealing, a stopped worker hands its chunks back as pending
+        using Range = ::std::pair<::std::size_t, ::std::size_t>;
+        auto const threads = static_cast<::std::size_t>(config.threads);
+        auto const chunk = ::std::max(::std::size_t{1}, ::std::min(::std::size_t{256}, names.size() / (threads * 8)));
+        ::std::vector<Range> ranges;
+        for (auto begin = ::std::size_t{0}; begin < names.size(); begin += chunk) ranges.emplace_back(begin, ::std::min(begin + chunk, names.size()));
+
+        storm.rearm(threshold);
+        auto &counters = Context::instance().counters;
+        counters.queued.store(names.size(), ::std::memory_order_relaxed);
+
+        Pool<Range>{threads}.run(::std::move(ranges), [&] (auto thread, auto &&range, auto const &) {
+            for (auto index = range.first; index < range.second; ++index) {
+                if (stopped() || storming() || full) {
+                    auto const lock = utils::makeUniqueLock(mutex); utils::unused(lock);
+                    result.complete = false; result.paused = result.paused || storming() || full;
+                    for (; index < range.second; ++index) result.pending.push(names[index]);
+                    return;
+                }
+                auto &&name = names[index].str();
+                moveOne(name, thread);
+                counters.queued.fetch_sub(1, ::std::memory_order_relaxed);
+            }
+        }, [&config, report] (auto index) { governor::apply(config.governor.copy, report && (0 == index)); });
+
+        result.moved = moved; result.failed = failed; result.deferred = deferred;
+        counters.queued.store(0, ::std::memory_order_relaxed);
+        counters.moved.fetch_add(result.moved, ::std::memory_order_relaxed);
+        counters.failed.fetch_add(result.failed, ::std::memory_order_relaxed);
+        counters.deferred.fetch_add(result.deferred, ::std::memory_order_relaxed);
+        if (full) Logger::instance<Logger::Category::Error>() << "Destination " << backend.destination() << " is full, pausing route " << config.src << " -> " << config.dst;
+        else if (result.paused) Logger::instance<Logger::Category::Error>() << "Route " << config.src << " -> " << config.dst << " failed " << storm.streak() << " times in a row the same way, pausing it";
+        return ::std::move(result);
+    }
+
+    // what a route keeps from one scan to the next; retries, storm, space and strategies are read for stats
+    // during a scan, the reactor thread touches the rest only while no scan runs
+    struct Route final {
+        Poller poller;
+        ::std::vector<Layout> layouts;
+        Tail tailer;
+        Storm storm;
+        Retry retries;
+        strategy::Table strategies;
+        Packer packer;
+        Space space;
+        Backlog pending;
+    };
+
+    struct Scan final { bool active = false, paused = false; };
+
+    // one tick of a route on the worker thread: lists the source, unless the poller says it didn't change, and moves
+    // or tails what it listed; a listing over backlog.memory is moved in batches. A failure of the scan itself
+    // is thrown with pending cleared and the poller told; shards adopted here are released by the caller
+    inline static auto scan(Route &route, Shards &shards, Config const &settings, bool report) noexcept(false) {
+        auto &context = Context::instance();
+        auto &poller = route.poller;
+        auto &pending = route.pending;
+        auto &&result = Scan{};
+        governor::apply(settings.governor.scan, report);
+        auto const prepare = [&settings] (auto index) { if (0 < index) governor::apply(settings.governor.scan, false); };
+        try {
+            auto const &filter = settings.filter.compiled;
+            auto const accept = [&shards, &filter] (auto const &name) { return shards.accepts(name) && ((! filter) || filter->accepts(name)); };
+            // a recursive walk starts from the top again for every batch, files waiting for their retry or skipped
+            // until they change don't count against its cap, or a backlog.memory of them would hide the rest for good;
+            // a flat listing goes on where it stopped, the mover defers them there
+            auto const eligible = [&settings, &route, &accept] (auto const &name) {
+                if (! accept(name)) return false;
+                auto const path = (stdfs::path{settings.src} / name).string();
+                return retry::Verdict::Defer != route.retries.verdict(name, [&path] (retry::Identity &identity) { return retry::identify(path, identity); });
+            };
+            // tail sources are a handful of growing files, their listing is never cut
+            auto const limit = settings.tail.enabled ? ::std::size_t{0} : static_cast<::std::size_t>(settings.backlog.memory) << 20;
+            if (shards.acquire()) poller.invalidate();
+            // segments left open by a crash are sealed before anything is listed
+            if (! stream::remote(settings.dst)) route.packer.configure(settings.dst, static_cast<::std::uint64_t>(settings.pack.size), static_cast<::std::uint64_t>(settings.pack.segment) << 20, settings.pack.age);
+
+            // a flat source keeps its directory stream open between batches,
+            // a recursive one is walked again while the previous batch moved something
+            auto &&flat = ::std::unique_ptr<walk::Listing>{};
+            auto &&directories = walk::Names{};
+            auto truncated = false;
+            auto const list = [&] () {
+                PURE_CXX_POSIX_PROBE(scan__start, settings.src.c_str());
+                if (settings.recursive) {
+                    auto &&walked = walk::tree(settings.src, static_cast<::std::size_t>(settings.threads), eligible, prepare, limit);
+                    pending = ::std::move(walked.files); truncated = walked.truncated;
+                    directories.insert(directories.end(), ::std::make_move_iterator(walked.directories.begin()), ::std::make_move_iterator(walked.directories.end()));
+                } else {
+                    if (! flat) flat.reset(new walk::Listing{settings.src});
+                    truncated = flat->fill(pending, accept, limit);
+                }
+                PURE_CXX_POSIX_PROBE(scan__done, settings.src.c_str(), pending.size());
+            };
+
+            // nested changes and appends don't touch the mtime of the root, so recursive and tail sources are always listed
+            if (pending.empty() && (poller.begin(settings.src) || settings.recursive || settings.tail.enabled)) {
+                context.counters.scans.fetch_add(1, ::std::memory_order_relaxed);
+                list();
+            }
+            if (settings.tail.enabled) {
+                route.tailer.open(settings.tail.state.empty() ? tail::path() : settings.tail.state);
+                auto const shipped = route.tailer.ship(settings.src, settings.dst, pending, stopped);
+                pending.clear();
+                result.active = 0 < shipped.shipped;
+                poller.end(shipped.complete && (0 == shipped.failed));
+                if (0 < shipped.shipped) Logger::instance() << "Tail shipped " << shipped.bytes << " bytes of " << shipped.shipped << " files";
+                return result;
+            }
+            if (pending.empty()) { poller.end(! truncated); return result; }
+
+            auto clean = true, complete = true;
+            auto deferred = ::std::size_t{0};
+            // one backend for all batches of the scan, its consumer connections outlive a batch
+            auto &&backend = backend::Posix{route.layouts, route.strategies, route.packer, route.space};
+            while (true) {
+                auto &&batch = run(backend, route.storm, route.retries, settings, ::std::move(pending), report);
+                pending.clear();
+                // the mover ran its first copy thread on this one, listing and pruning are scan work again
+                governor::apply(settings.governor.scan, false);
+                // packed sources are unlinked here, before they could be listed again
+                route.packer.commit();
+                result.active = result.active || (0 < batch.moved); result.paused = batch.paused; deferred += batch.deferred;
+                clean = clean && (0 == batch.failed) && (0 == batch.deferred);
+                if (! batch.complete) { complete = false; if (context.drain) pending = ::std::move(batch.pending); break; }
+                if ((! truncated) || (settings.recursive && (0 == batch.moved))) break;
+                list();
+                if (pending.empty()) break;
+            }
+            if (0 < deferred) Logger::instance() << deferred << " failed files are waiting for their retry";
+            // only a scan whose batches saw every listed file may forget the failures of the others
+            if (complete && (! truncated)) route.retries.sweep();
+            if (pending.empty()) poller.end(complete && clean && (! truncated));
+            // directories emptied by an earlier batch are only known to the walk of that batch
+            if (complete && (! directories.empty())) { walk::deepest(directories); walk::prune(settings.src, directories); }
+            return result;
+        } catch(...) { pending.clear(); poller.end(false); throw; }
+    }
+
+    // the failures that repeated since their full report, once per storm.interval
+    inline static auto summarize(Storm &storm, Config::Delay interval) noexcept(false) {
+        for (auto const &summary : storm.expired(interval)) Logger::instance<Logger::Category::Error>()
+            << "Failed " << summary.count << " more times with " << summary.key.site << ": " << ::std::error_code{summary.key.code, ::std::generic_category()}.message()
+            << ", the last one is " << summary.last;
+    }
+
+} // namespace mover
+} // namespace pure_cxx_posix
+
+#else
+#error "__cplusplus not defined. c++14 or hight is required"
+#endif // defined(__cplusplus) && (201402L <= __cplusplus)
+#endif // PURE_CXX_POSIX_MOVER_HPP
@@ -0,0 +1,275 @@
+#ifndef PURE_CXX_POSIX_PACKER_HPP
+#define PURE_CXX_POSIX_PACKER_HPP
+#pragma once
+#if defined(__cplusplus) && (201402L <= __cplusplus)
+
+#include <ctime>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+
+#include <mutex>
+#include <chrono>
+#include <string>
+#include <vector>
+#include <utility>
+#include <stdexcept>
+#include <system_error>
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/file.h>
+#include <sys/stat.h>
+
+#include "span.hpp"
+#include "retry.hpp"
+#include "engine.hpp"
+#include "logger.hpp"
+#include "segment.hpp"
+#include "space.hpp"
+#include "checksum.hpp"
+#include "descriptor.hpp"
+#include "exception.hpp"
+#include "utils.hpp"
+#include "stdfs.hpp"
+
+
+namespace pure_cxx_posix {
+namespace packer {
+
+    // small files are appended to one open segment of the destination instead of being created
+    // there one by one: a batch costs one fdatasync, its sources are unlinked after it, and a
+    // segment is sealed with its index once it is big or old enough, see segment.hpp;
+    // a crash between the sync and the unlinks packs those files again, delivery is at least once
+    struct Type final {
+        // seals the segment of a previous destination and the ones left open by a crash in this one
+        inline auto configure(stdfs::path const &directory, ::std::uint64_t size, ::std::uint64_t limit, double age) noexcept(false);
+
+        inline auto enabled() const noexcept(true) { return 0 < mSize; }
+
+        // appends a file of up to the size limit, packed is false for a bigger one and nothing is done;
+        // the source is unlinked by the next commit, space admits the record when set
+        inline auto append(stdfs::path const &src, ::std::string const &name, space::Type *space, bool &packed, Span &span) noexcept(false);
+
+        // makes the appended files durable, unlinks their sources and seals the segment when due
+        inline auto commit() noexcept(false) { finish(false); }
+        inline auto seal() noexcept(false) { finish(true); }
+
+        Type() = default;
+        inline ~Type() noexcept(true) { try { seal(); } catch(...) {} }
+
+        Type(Type const &) = delete;
+        Type & operator = (Type const &) = delete;
+
+    private:
+        struct Source final { stdfs::path path; retry::Identity identity; };
+
+        ::std::mutex mMutex;
+        stdfs::path mDirectory, mPath;
+        ::std::uint64_t mSize = 0, mLimit = 0;
+        double mAge = +0.0e+0;
+        Descriptor mSegment;
+        ::std::uint64_t mOffset = 0, mCommitted = 0, mSequence = 0;
+        ::std::chrono::steady_clock::time_point mOpened;
+        ::std::vector<segment::Entry> mEntries;
+        ::std::vector<Source> mSources;
+
+        inline auto finish(bool all) noexcept(false) -> void;
+        inline auto open() noexcept(false);
+
+        // writes the index and the trailer after offset and gives the segment its final name
+        inline auto close(int descriptor, stdfs::path const &path, ::std::uint64_t offset, ::std::vector<segment::Entry> const &entries) noexcept(false) -> void;
+        inline auto recover(stdfs::path const &path) noexcept(false) -> void;
+
+        inline static auto write(int descriptor, void const *data, ::std::size_t size, ::std::uint64_t offset) noexcept(true) {
+            for (auto const *bytes = static_cast<char const *>(data); 0 < size;) {
+                auto const count = ::pwrite(descriptor, bytes, size, static_cast<::off_t>(offset));
+                if ((0 > count) && (EINTR == errno)) continue;
+                if (0 > count) return false;
+                bytes += count; size -= static_cast<::std::size_t>(count); offset += static_cast<::std::uint64_t>(count);
+            }
+            return true;
+        }
+    };
+
+    inline auto Type::configure(stdfs::path const &directory, ::std::uint64_t size, ::std::uint64_t limit, double age) noexcept(false) {
+        {
+            auto const lock = utils::makeUniqueLock(mMutex); utils::unused(lock);
+            mSize = size; mLimit = limit; mAge = age;
+            if (directory == mDirectory) return;
+        }
+        seal();
+        mDirectory = directory;
+        if (! enabled()) return;
+        // a segment locked by another daemon on the same destination is still being written
+        auto &&leftovers = ::std::vector<stdfs::path>{};
+        for (auto const &entry : stdfs::directory_iterator{mDirectory}) {
+            auto const name = entry.path().filename().native();
+            if ((0 == name.compare(0, 8, ".pcxxpd-")) && (name.size() > sizeof(segment::pending)) && (0 == name.compare(name.size() - sizeof(segment::pending) + 1, ::std::string::npos, segment::pending))) {
+                leftovers.push_back(entry.path());
+            }
+        }
+        for (auto const &path : leftovers) try { recover(path); } catch(...) {
+            Logger::instance<Logger::Category::Error>() << "Failed to recover segment " << path << ": " << utils::errorCodeToString();
+        }
+    }
+
+    inline auto Type::open() noexcept(false) {
+        auto const name = ".pcxxpd-" + ::std::to_string(::getpid()) + "-" + ::std::to_string(++mSequence) + segment::pending;
+        mPath = mDirectory / name;
+        // the segment is locked before it has a name, so recovery by another daemon on this destination
+        // never finds it unlocked; without O_TMPFILE it is locked under a name recovery ignores
+        auto &&segment = Descriptor{::open(mDirectory.c_str(), O_TMPFILE | O_RDWR | O_CLOEXEC, 0644)};
+        if (segment) {
+            if (0 != ::flock(segment.get(), LOCK_EX | LOCK_NB)) return false;
+            auto const handle = "/proc/self/fd/" + ::std::to_string(segment.get());
+            if (0 != ::linkat(AT_FDCWD, handle.c_str(), AT_FDCWD, mPath.c_str(), AT_SYMLINK_FOLLOW)) return false;
+        } else {
+            if ((EOPNOTSUPP != errno) && (EISDIR != errno)) return false;
+            auto const fresh = mPath.native() + ".new";
+            segment.reset(::open(fresh.c_str(), O_RDWR | O_CREAT | O_EXCL | O_CLOEXEC, 0644));
+            if (! segment) return false;
+            if ((0 != ::flock(segment.get(), LOCK_EX | LOCK_NB)) || (0 != ::rename(fresh.c_str(), mPath.c_str()))) { auto const code = errno; ::unlink(fresh.c_str()); errno = code; return false; }
+        }
+        mSegment = ::std::move(segment);
+        mOffset = mCommitted = 0;
+        mOpened = ::std::chrono::steady_clock::now();
+        return true;
+    }
+
+    inline auto Type::append(stdfs::path const &src, ::std::string const &name, space::Type *space, bool &packed, Span &span) noexcept(false) {
+        packed = false;
+        auto in = Descriptor{::open(src.c_str(), O_RDONLY | O_CLOEXEC)};
+        if (! in) return engine::Status::failure(errno, "open");
+        struct ::stat information;
+        if (0 != ::fstat(in.get(), &information)) return engine::Status::failure(errno, "fstat");
+        if (! S_ISREG(information.st_mode)) return engine::Status::failure(EINVAL, "open");
+        if (mSize < static_cast<::std::uint64_t>(information.st_size)) return engine::Status::success();
+        packed = true;
+        span.mark(span::Open);
+
+        // the whole record is built outside the lock, the lock only covers its position in the segment
+        auto size = static_cast<::std::uint64_t>(information.st_size);
+        auto const length = static_cast<::std::uint32_t>(name.size());
+        auto &&record = ::std::vector<char>(static_cast<::std::size_t>(segment::end(0, length, size)), 0);
+        auto const data = static_cast<::std::size_t>(segment::data(0, length));
+        space::Reservation reservation{space, record.size()};
+        if (! reservation.admitted()) return engine::Status::failure(ENOSPC, "admit");
+        for (auto done = ::std::uint64_t{0}; done < size;) {
+            auto const count = ::read(in.get(), record.data() + data + done, static_cast<::std::size_t>(size - done));
+            if ((0 > count) && (EINTR == errno)) continue;
+            if (0 > count) return engine::Status::failure(errno, "read");
+            if (0 == count) { size = done; break; }
+            done += static_cast<::std::uint64_t>(count);
+        }
+        auto header = segment::Record{};
+        header.length = length; header.size = size; header.checksum = checksum::make(record.data() + data, static_cast<::std::size_t>(size));
+        ::std::memcpy(record.data(), &header, sizeof(header));
+        ::std::memcpy(record.data() + segment::name(0), name.data(), name.size());
+        record.resize(static_cast<::std::size_t>(segment::end(0, length, size)));
+        span.mark(span::Checksum);
+
+        auto &&source = Source{src, retry::Identity{}};
+        source.identity.device = information.st_dev; source.identity.inode = information.st_ino;
+        source.identity.size = static_cast<::std::uint64_t>(information.st_size);
+        source.identity.mtime = ::std::int64_t{information.st_mtim.tv_sec} * 1000000000 + information.st_mtim.tv_nsec;
+        in.reset();
+
+        auto const lock = utils::makeUniqueLock(mMutex); utils::unused(lock);
+        if ((! mSegment) && (! open())) return engine::Status::failure(errno, "open segment");
+        // a torn record is overwritten by the next one or cut off when the segment is sealed
+        if (! write(mSegment.get(), record.data(), record.size(), mOffset)) return engine::Status::failure(errno, "write");
+        mEntries.push_back(segment::Entry{mOffset, size, header.checksum, length, 0});
+        mSources.push_back(::std::move(source));
+        mOffset += record.size();
+        reservation.written = true;
+        span.mark(span::Copy);
+        return engine::Status::success();
+    }
+
+    inline auto Type::finish(bool all) noexcept(false) -> void {
+        auto const lock = utils::makeUniqueLock(mMutex); utils::unused(lock);
+        if (! mSegment) return;
+        if (mCommitted < mOffset) {
+            if (0 != ::fdatasync(mSegment.get())) {
+                // files of a failed sync stay in the source and are packed again
+                Logger::instance<Logger::Category::Error>() << "Failed to sync segment " << mPath << ": " << utils::errorCodeToString() << ", dropping " << mSources.size() << " files from it";
+                auto const committed = mEntries.size() - mSources.size();
+                mEntries.resize(committed); mSources.clear();
+                mOffset = mCommitted;
+            }
+            // a source replaced since it was packed is left for the next scan
+            for (auto const &source : mSources) {
+                auto &&identity = retry::Identity{};
+                if ((! retry::identify(source.path, identity)) || (! (identity == source.identity))) continue;
+                if (0 != ::unlink(source.path.c_str())) Logger::instance<Logger::Category::Error>() << "Failed to unlink packed " << source.path << ": " << utils::errorCodeToString();
+            }
+            mSources.clear();
+            mCommitted = mOffset;
+        }
+        auto const age = ::std::chrono::duration<double>{::std::chrono::steady_clock::now() - mOpened}.count();
+        if ((! all) && (mOffset < mLimit) && (age < mAge)) return;
+        auto const segment = ::std::move(mSegment);
+        auto const entries = ::std::move(mEntries);
+        auto const offset = ::std::exchange(mOffset, 0);
+        mEntries.clear(); mCommitted = 0;
+        if (entries.empty()) { ::unlink(mPath.c_str()); return; }
+        close(segment.get(), mPath, offset, entries);
+    }
+
+    inline auto Type::close(int descriptor, stdfs::path const &path, ::std::uint64_t offset, ::std::vector<segment::Entry> const &entries) noexcept(false) -> void {
+        auto trailer = segment::Trailer{};
+        trailer.count = entries.size(); trailer.index = offset;
+        trailer.checksum = checksum::make(entries.data(), entries.size() * sizeof(segment::Entry));
+        auto const index = entries.size() * sizeof(segment::Entry);
+        auto const length = offset + index + sizeof(trailer);
+        if ((! write(descriptor, entries.data(), index, offset)) || (! write(descriptor, &trailer, sizeof(trailer), offset + index))
+            || (0 != ::ftruncate(descriptor, static_cast<::off_t>(length))) || (0 != ::fdatasync(descriptor))) {
+            throw PURE_CXX_POSIX_EXCEPTION_MAKE(::std::runtime_error{"failed to seal segment " + path.native() + ": " + utils::errorCodeToString()});
+        }
+        auto const name = ::std::to_string(::std::time(nullptr)) + path.filename().native().substr(7, path.filename().native().size() - 7 - sizeof(segment::pending) + 1) + segment::suffix;
+        auto const target = path.parent_path() / name;
+        if (0 != ::rename(path.c_str(), target.c_str())) {
+            throw PURE_CXX_POSIX_EXCEPTION_MAKE(::std::runtime_error{"failed to rename segment " + path.native() + ": " + utils::errorCodeToString()});
+        }
+        auto const directory = Descriptor{::open(path.parent_path().c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC)};
+        if (directory) ::fsync(directory.get());
+        Logger::instance() << "Sealed segment " << target << " with " << entries.size() << " files";
+    }
+
+    // the records of a segment up to the first torn one, which is cut off with everything after it
+    inline auto Type::recover(stdfs::path const &path) noexcept(false) -> void {
+        auto const descriptor = Descriptor{::open(path.c_str(), O_RDWR | O_CLOEXEC)};
+        if (! descriptor) throw PURE_CXX_POSIX_EXCEPTION_MAKE(::std::runtime_error{"open"});
+        if (0 != ::flock(descriptor.get(), LOCK_EX | LOCK_NB)) return;
+        struct ::stat information;
+        if (0 != ::fstat(descriptor.get(), &information)) throw PURE_CXX_POSIX_EXCEPTION_MAKE(::std::runtime_error{"fstat"});
+        auto const size = static_cast<::std::uint64_t>(information.st_size);
+        auto &&entries = ::std::vector<segment::Entry>{};
+        auto &&buffer = ::std::vector<char>{};
+        auto offset = ::std::uint64_t{0};
+        for (auto header = segment::Record{}; offset + sizeof(header) <= size; offset = segment::end(offset, header.length, header.size)) {
+            if (static_cast<::ssize_t>(sizeof(header)) != ::pread(descriptor.get(), &header, sizeof(header), static_cast<::off_t>(offset))) break;
+            // the header of a torn record is garbage, its size is checked against the file before it is summed or allocated
+            auto const data = segment::data(offset, header.length);
+            if ((segment::Record::signature != header.magic) || (size < data) || (size - data < header.size)) break;
+            buffer.resize(static_cast<::std::size_t>(header.size));
+            if (static_cast<::ssize_t>(buffer.size()) != ::pread(descriptor.get(), buffer.data(), buffer.size(), static_cast<::off_t>(data))) break;
+            if (checksum::make(buffer.data(), buffer.size()) != header.checksum) break;
+            entries.push_back(segment::Entry{offset, header.size, header.checksum, header.length, 0});
+        }
+        Logger::instance() << "Recovering segment " << path << " with " << entries.size() << " files, their sources may be packed again";
+        if (entries.empty()) { ::unlink(path.c_str()); return; }
+        close(descriptor.get(), path, offset, entries);
+    }
+
+} // namespace packer
+
+    using Packer = packer::Type;
+
+} // namespace pure_cxx_posix
+
+#else
+#error "__cplusplus not defined. c++14 or hight is required"
+#endif // defined(__cplusplus) && (201402L <= __cplusplus)
+#endif // PURE_CXX_POSIX_PACKER_HPP
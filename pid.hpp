@@ -16,6 +16,7 @@
 #include <sys/file.h>
 #include <sys/types.h>
 
+#include "probe.hpp"
 #include "logger.hpp"
 #include "context.hpp"
 #include "exception.hpp"
@@ -57,6 +58,7 @@ namespace pid {
         auto const &&pid = ::getpid();
         using Pid = ::std::decay_t<decltype(pid)>;
         Logger::instance() << "My pid is: " << pid;
+        PURE_CXX_POSIX_PROBE(pid__lock, pid);
 
         auto const &&path = [] () { try { return pid::path(); } catch(...) {
             throw PURE_CXX_POSIX_EXCEPTION_MAKE_FROM_CURRENT(::std::runtime_error{"failed to get pidflie path"});
@@ -117,6 +119,7 @@ namespace pid {
             }
         } catch(...) { ::close(descriptor); throw; }
 
+        PURE_CXX_POSIX_PROBE(pid__locked, pid, descriptor);
         using Path = ::std::decay_t<decltype(path)>;
         using Descriptor = ::std::decay_t<decltype(descriptor)>;
         struct Result final { Pid pid = 0; Path path; Descriptor descriptor = -1; };
@@ -0,0 +1,95 @@
+#ifndef PURE_CXX_POSIX_POLLER_HPP
+#define PURE_CXX_POSIX_POLLER_HPP
+#pragma once
+#if defined(__cplusplus) && (201402L <= __cplusplus)
+
+#include <ctime>
+#include <cstdint>
+
+#include <utility>
+#include <algorithm>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+
+
+namespace pure_cxx_posix {
+namespace poller {
+
+    struct Stamp final {
+        ::std::uint64_t device = 0, inode = 0;
+        ::std::int64_t mtime = 0, ctime = 0;
+        bool valid = false;
+    };
+
+    inline static auto operator == (Stamp const &a, Stamp const &b) noexcept(true) {
+        return a.valid && b.valid && (a.device == b.device) && (a.inode == b.inode) && (a.mtime == b.mtime) && (a.ctime == b.ctime);
+    }
+
+    inline static auto operator != (Stamp const &a, Stamp const &b) noexcept(true) { return ! (a == b); }
+
+    // timestamps of some filesystems tick by the second or the jiffy: a directory changed within
+    // the last tick may change again without its mtime moving, such a stamp is never trusted
+    constexpr static ::std::int64_t const granularity = 1000000000;
+
+    // one forced statx, so that nfs attribute caching can't hide a change
+    template <class T> inline static auto stamp(T const &path) noexcept(true) {
+        auto &&result = Stamp{};
+        struct ::statx buffer;
+        constexpr static auto const mask = STATX_INO | STATX_MTIME | STATX_CTIME;
+        if (0 != ::statx(AT_FDCWD, path.c_str(), AT_STATX_FORCE_SYNC, mask, &buffer)) return ::std::move(result);
+        if (mask != (buffer.stx_mask & mask)) return ::std::move(result);
+        auto const nanoseconds = [] (auto const &time) { return ::std::int64_t{time.tv_sec} * 1000000000 + time.tv_nsec; };
+        result.device = (::std::uint64_t{buffer.stx_dev_major} << 32) | buffer.stx_dev_minor;
+        result.inode = buffer.stx_ino;
+        result.mtime = nanoseconds(buffer.stx_mtime);
+        result.ctime = nanoseconds(buffer.stx_ctime);
+        struct ::timespec now;
+        if (0 != ::clock_gettime(CLOCK_REALTIME, &now)) return ::std::move(result);
+        result.valid = nanoseconds(now) - ::std::max(result.mtime, result.ctime) >= granularity;
+        return ::std::move(result);
+    }
+
+    struct Type final {
+        using Interval = double;
+
+        Interval interval = +0.0e+0;
+
+        // true when the directory has to be listed
+        template <class T> inline auto begin(T const &path) noexcept(true) {
+            mPending = poller::stamp(path);
+            return mPending != mStamp;
+        }
+
+        // a stamp is trusted only after a scan that left nothing behind
+        inline auto end(bool clean) noexcept(true) { mStamp = clean ? mPending : Stamp{}; mPending = Stamp{}; }
+
+        inline auto invalidate() noexcept(true) { mStamp = Stamp{}; }
+
+        inline auto const & stamp() const noexcept(true) { return mStamp; }
+        inline auto const & pending() const noexcept(true) { return mPending; }
+
+        // takes over a predecessor's stamp, unfinished is the stamp of a scan whose names are still pending
+        inline auto inherit(Stamp const &value, bool unfinished) noexcept(true) { (unfinished ? mPending : mStamp) = value; }
+        inline auto reset(Interval value) noexcept(true) { interval = value; mStamp = Stamp{}; mPending = Stamp{}; }
+
+        inline auto adapt(bool active, Interval floor, Interval ceiling) noexcept(true) {
+            interval = active ? interval / +2.0e+0 : interval * +2.0e+0;
+            interval = ::std::min(::std::max(interval, floor), ceiling);
+            return interval;
+        }
+
+    private:
+        Stamp mStamp, mPending;
+    };
+
+} // namespace poller
+
+    using Poller = poller::Type;
+
+} // namespace pure_cxx_posix
+
+#else
+#error "__cplusplus not defined. c++14 or hight is required"
+#endif // defined(__cplusplus) && (201402L <= __cplusplus)
+#endif // PURE_CXX_POSIX_POLLER_HPP
@@ -0,0 +1,133 @@
+#ifndef PURE_CXX_POSIX_POOL_HPP
+#define PURE_CXX_POSIX_POOL_HPP
+#pragma once
+#if defined(__cplusplus) && (201402L <= __cplusplus)
+
+#include <deque>
+#include <mutex>
+#include <atomic>
+#include <thread>
+#include <vector>
+#include <utility>
+#include <exception>
+#include <condition_variable>
+
+#include "utils.hpp"
+
+
+namespace pure_cxx_posix {
+namespace pool {
+
+    // work-stealing run over a set of items: every thread pops its own queue from the back
+    // and steals from the front of the others, handlers may push new items while running
+    template <class T> struct Type final {
+        using Item = T;
+
+        // handler(index of the thread, item, push), returns after all items and everything pushed are handled,
+        // prepare(index of the thread) runs once on every thread before it takes its first item
+        template <class F, class P> inline auto run(::std::vector<Item> seeds, F &&handler, P &&prepare) noexcept(false);
+        template <class F> inline auto run(::std::vector<Item> seeds, F &&handler) noexcept(false) { return run(::std::move(seeds), ::std::forward<F>(handler), [] (auto) {}); }
+
+        inline explicit Type(::std::size_t threads) noexcept(false) : mQueues(0 < threads ? threads : 1) {}
+
+    private:
+        struct Queue final { ::std::mutex mutex; ::std::deque<Item> items; };
+
+        ::std::vector<Queue> mQueues;
+        ::std::atomic<::std::size_t> mOutstanding{0};
+        ::std::atomic<bool> mFailed{false};
+        ::std::exception_ptr mException;
+        ::std::mutex mMutex;
+        // idle workers sleep on mIdle until something is pushed, the run drains or fails
+        ::std::condition_variable mIdle;
+        ::std::atomic<::std::size_t> mPushed{0};
+
+        inline auto take(::std::size_t index, Item &item) noexcept(false);
+        inline auto push(::std::size_t index, Item &&item) noexcept(false);
+        inline auto wake(bool all) noexcept(true) -> void;
+        template <class F, class P> inline auto work(::std::size_t index, F &handler, P &prepare) noexcept(true);
+    };
+
+    template <class T> inline auto Type<T>::take(::std::size_t index, Item &item) noexcept(false) {
+        {
+            auto &queue = mQueues[index];
+            auto const lock = utils::makeUniqueLock(queue.mutex); utils::unused(lock);
+            if (! queue.items.empty()) { item = ::std::move(queue.items.back()); queue.items.pop_back(); return true; }
+        }
+        for (auto offset = ::std::size_t{1}; offset < mQueues.size(); ++offset) {
+            auto &queue = mQueues[(index + offset) % mQueues.size()];
+            auto const lock = utils::makeUniqueLock(queue.mutex); utils::unused(lock);
+            if (! queue.items.empty()) { item = ::std::move(queue.items.front()); queue.items.pop_front(); return true; }
+        }
+        return false;
+    }
+
+    template <class T> inline auto Type<T>::push(::std::size_t index, Item &&item) noexcept(false) {
+        {
+            auto &queue = mQueues[index];
+            auto const lock = utils::makeUniqueLock(queue.mutex); utils::unused(lock);
+            queue.items.push_back(::std::move(item));
+            mOutstanding.fetch_add(1, ::std::memory_order_acq_rel);
+        }
+        wake(false);
+    }
+
+    template <class T> inline auto Type<T>::wake(bool all) noexcept(true) -> void {
+        {
+            auto const lock = utils::makeUniqueLock(mMutex); utils::unused(lock);
+            mPushed.fetch_add(1, ::std::memory_order_acq_rel);
+        }
+        if (all) mIdle.notify_all(); else mIdle.notify_one();
+    }
+
+    template <class T> template <class F, class P> inline auto Type<T>::work(::std::size_t index, F &handler, P &prepare) noexcept(true) {
+        auto const push = [this, index] (Item &&item) { this->push(index, ::std::move(item)); };
+        auto &&item = Item{};
+        try { prepare(index); } catch(...) {}
+        while (! mFailed.load(::std::memory_order_acquire)) try {
+            // a push after this read changes mPushed, so the wait below can't miss it
+            auto const pushed = mPushed.load(::std::memory_order_acquire);
+            if (take(index, item)) {
+                handler(index, ::std::move(item), push);
+                if (1 == mOutstanding.fetch_sub(1, ::std::memory_order_acq_rel)) wake(true);
+                continue;
+            }
+            if (0 == mOutstanding.load(::std::memory_order_acquire)) break;
+            auto lock = utils::makeUniqueLock(mMutex);
+            mIdle.wait(lock, [this, pushed] () { return (pushed != mPushed.load(::std::memory_order_acquire)) || mFailed.load(::std::memory_order_acquire); });
+        } catch(...) {
+            {
+                auto const lock = utils::makeUniqueLock(mMutex); utils::unused(lock);
+                if (! mException) mException = ::std::current_exception();
+                mFailed.store(true, ::std::memory_order_release);
+            }
+            mIdle.notify_all();
+        }
+    }
+
+    template <class T> template <class F, class P> inline auto Type<T>::run(::std::vector<Item> seeds, F &&handler, P &&prepare) noexcept(false) {
+        mFailed = false; mException = nullptr;
+        for (auto index = ::std::size_t{0}; index < seeds.size(); ++index) push(index % mQueues.size(), ::std::move(seeds[index]));
+
+        // the calling thread is the first worker, a single thread pool never spawns
+        ::std::vector<::std::thread> threads; threads.reserve(mQueues.size() - 1);
+        try { for (auto index = ::std::size_t{1}; index < mQueues.size(); ++index) threads.emplace_back([this, index, &handler, &prepare] () { work(index, handler, prepare); }); }
+        catch(...) { mFailed = true; wake(true); for (auto &thread : threads) thread.join(); throw; }
+        work(0, handler, prepare);
+        for (auto &thread : threads) thread.join();
+
+        for (auto &queue : mQueues) queue.items.clear();
+        mOutstanding = 0;
+        if (mException) ::std::rethrow_exception(mException);
+    }
+
+} // namespace pool
+
+    template <class T> using Pool = pool::Type<T>;
+
+} // namespace pure_cxx_posix
+
+#else
+#error "__cplusplus not defined. c++14 or hight is required"
+#endif // defined(__cplusplus) && (201402L <= __cplusplus)
+#endif // PURE_CXX_POSIX_POOL_HPP
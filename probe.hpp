@@ -0,0 +1,23 @@
+#ifndef PURE_CXX_POSIX_PROBE_HPP
+#define PURE_CXX_POSIX_PROBE_HPP
+#pragma once
+#if defined(__cplusplus) && (201402L <= __cplusplus)
+
+// static tracepoints of the "pcxxpd" provider, a disabled one is a single nop in the text,
+// so they stay in production builds: bpftrace -e 'usdt:./pcxxpd:pcxxpd:copy__done { ... }'
+// without <sys/sdt.h> they compile to nothing and their arguments are not evaluated
+#if defined(__has_include)
+#if __has_include(<sys/sdt.h>)
+#include <sys/sdt.h>
+#define PURE_CXX_POSIX_PROBE(name, ...) STAP_PROBEV(pcxxpd, name, ##__VA_ARGS__)
+#endif
+#endif
+
+#if ! defined(PURE_CXX_POSIX_PROBE)
+#define PURE_CXX_POSIX_PROBE(...) static_cast<void>(0)
+#endif
+
+#else
+#error "__cplusplus not defined. c++14 or hight is required"
+#endif // defined(__cplusplus) && (201402L <= __cplusplus)
+#endif // PURE_CXX_POSIX_PROBE_HPP
@@ -0,0 +1,153 @@
+#ifndef PURE_CXX_POSIX_RCU_HPP
+#define PURE_CXX_POSIX_RCU_HPP
+#pragma once
+#if defined(__cplusplus) && (201402L <= __cplusplus)
+
+#include <array>
+#include <mutex>
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+#include <utility>
+#include <algorithm>
+#include <type_traits>
+
+#include "utils.hpp"
+
+
+namespace pure_cxx_posix {
+namespace rcu {
+
+    // immutable snapshots published through an atomic pointer, readers are protected by hazard slots
+    template <class T> struct Type final {
+        using Value = T;
+        using Pointer = Value const *;
+
+        struct Guard;
+
+        inline auto read() const noexcept(true);
+
+        template <class ... A> inline auto publish(A && ... arguments) noexcept(false);
+        // action(Value &) edits a copy of the current value under the writer lock, so concurrent
+        // updates never lose each other's changes; nothing is published when it throws
+        template <class F> inline auto update(F &&action) noexcept(false);
+
+        template <class ... A> inline explicit Type(A && ... arguments) noexcept(false) : mCurrent{new Value{::std::forward<A>(arguments) ...}} {}
+        inline ~Type() noexcept(true);
+
+        Type(Type &&) = delete;
+        Type(Type const &) = delete;
+        template <class U> Type & operator = (U &&) = delete;
+
+    private:
+        struct Slot final { ::std::atomic<bool> busy{false}; ::std::atomic<Pointer> hazard{nullptr}; };
+
+        constexpr static ::std::size_t const slotsCount = 64;
+
+        ::std::atomic<Pointer> mCurrent;
+        mutable ::std::array<Slot, slotsCount> mSlots;
+        ::std::mutex mWriter;
+        ::std::vector<Pointer> mRetired;
+
+        inline auto & acquire() const noexcept(true);
+        inline auto reclaim() noexcept(false);
+        inline auto replace(Pointer fresh) noexcept(false) -> void;
+    };
+
+    template <class T> struct Type<T>::Guard final {
+        inline auto get() const noexcept(true) { return mPointer; }
+        inline auto operator -> () const noexcept(true) { return mPointer; }
+        inline auto & operator * () const noexcept(true) { return *mPointer; }
+
+        inline ~Guard() noexcept(true) { release(); }
+
+        inline Guard(Guard &&other) noexcept(true) : mSlot{other.mSlot}, mPointer{other.mPointer} { other.mSlot = nullptr; }
+        Guard(Guard const &) = delete;
+        template <class U> Guard & operator = (U &&) = delete;
+
+    private:
+        friend Type;
+
+        Slot *mSlot;
+        Pointer mPointer;
+
+        inline explicit Guard(Slot &slot, Pointer pointer) noexcept(true) : mSlot{&slot}, mPointer{pointer} {}
+
+        inline auto release() noexcept(true) {
+            if (! static_cast<bool>(mSlot)) return;
+            mSlot->hazard.store(nullptr, ::std::memory_order_release);
+            mSlot->busy.store(false, ::std::memory_order_release);
+            mSlot = nullptr;
+        }
+    };
+
+    template <class T> inline auto & Type<T>::acquire() const noexcept(true) {
+        while (true) {
+            for (auto &slot : mSlots) if (! slot.busy.exchange(true, ::std::memory_order_acquire)) return slot;
+            ::std::this_thread::yield();
+        }
+    }
+
+    template <class T> inline auto Type<T>::read() const noexcept(true) {
+        auto &slot = acquire();
+        auto pointer = mCurrent.load(::std::memory_order_acquire);
+        while (true) {
+            slot.hazard.store(pointer, ::std::memory_order_seq_cst);
+            auto const again = mCurrent.load(::std::memory_order_seq_cst);
+            if (again == pointer) break;
+            pointer = again;
+        }
+        return Guard{slot, pointer};
+    }
+
+    template <class T> inline auto Type<T>::reclaim() noexcept(false) {
+        ::std::vector<Pointer> hazards; hazards.reserve(mSlots.size());
+        for (auto const &slot : mSlots) {
+            auto const pointer = slot.hazard.load(::std::memory_order_seq_cst);
+            if (static_cast<bool>(pointer)) hazards.push_back(pointer);
+        }
+        auto const end = ::std::partition(mRetired.begin(), mRetired.end(), [&hazards] (auto const pointer) {
+            return hazards.end() != ::std::find(hazards.begin(), hazards.end(), pointer);
+        });
+        ::std::for_each(end, mRetired.end(), [] (auto const pointer) { delete pointer; });
+        mRetired.erase(end, mRetired.end());
+    }
+
+    // under the writer lock, takes ownership of fresh
+    template <class T> inline auto Type<T>::replace(Pointer fresh) noexcept(false) -> void {
+        auto owner = ::std::unique_ptr<Value const>{fresh};
+        mRetired.reserve(mRetired.size() + 1);
+        mRetired.push_back(mCurrent.exchange(owner.release(), ::std::memory_order_seq_cst));
+        reclaim();
+    }
+
+    template <class T> template <class ... A> inline auto Type<T>::publish(A && ... arguments) noexcept(false) {
+        auto fresh = ::std::make_unique<Value const>(::std::forward<A>(arguments) ...);
+        auto const lock = utils::makeUniqueLock(mWriter); utils::unused(lock);
+        replace(fresh.release());
+    }
+
+    // only writers retire values and they hold the lock, so the current one can be read without a hazard
+    template <class T> template <class F> inline auto Type<T>::update(F &&action) noexcept(false) {
+        auto const lock = utils::makeUniqueLock(mWriter); utils::unused(lock);
+        auto fresh = ::std::make_unique<Value>(*mCurrent.load(::std::memory_order_acquire));
+        ::std::forward<F>(action)(*fresh);
+        replace(fresh.release());
+    }
+
+    template <class T> inline Type<T>::~Type() noexcept(true) {
+        for (auto const pointer : mRetired) delete pointer;
+        delete mCurrent.load(::std::memory_order_acquire);
+    }
+
+} // namespace rcu
+
+    template <class T> using Rcu = rcu::Type<T>;
+
+} // namespace pure_cxx_posix
+
+#else
+#error "__cplusplus not defined. c++14 or hight is required"
+#endif // defined(__cplusplus) && (201402L <= __cplusplus)
+#endif // PURE_CXX_POSIX_RCU_HPP
@@ -0,0 +1,185 @@
+#ifndef PURE_CXX_POSIX_REACTOR_HPP
+#define PURE_CXX_POSIX_REACTOR_HPP
+#pragma once
+#if defined(__cplusplus) && (201402L <= __cplusplus)
+
+#include <cerrno>
+#include <cmath>
+#include <cstdint>
+
+#include <map>
+#include <array>
+#include <memory>
+#include <utility>
+#include <stdexcept>
+#include <functional>
+#include <initializer_list>
+
+#include <signal.h>
+#include <unistd.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/timerfd.h>
+#include <sys/signalfd.h>
+
+#include "descriptor.hpp"
+#include "exception.hpp"
+#include "utils.hpp"
+
+
+namespace pure_cxx_posix {
+namespace reactor {
+
+    using Events = ::std::uint32_t;
+    using Handler = ::std::function<void(Events)>;
+
+    struct Type final {
+        using Events = reactor::Events;
+        using Handler = reactor::Handler;
+
+        inline auto add(int descriptor, Events events, Handler &&handler) noexcept(false);
+        inline auto remove(int descriptor) noexcept(false);
+
+        inline auto run() noexcept(false);
+        inline auto stop() noexcept(true) { mCondition = false; }
+
+        inline Type() noexcept(false);
+
+        Type(Type &&) = delete;
+        Type(Type const &) = delete;
+        template <class T> Type & operator = (T &&) = delete;
+
+    private:
+        Descriptor mEpoll;
+        bool mCondition = true;
+        ::std::map<int, ::std::shared_ptr<Handler>> mHandlers;
+    };
+
+    inline Type::Type() noexcept(false) : mEpoll{::epoll_create1(EPOLL_CLOEXEC)} {
+        if (! mEpoll) throw PURE_CXX_POSIX_EXCEPTION_MAKE(::std::runtime_error{"epoll_create1() failure: " + utils::errorCodeToString()});
+    }
+
+    inline auto Type::add(int descriptor, Events events, Handler &&handler) noexcept(false) {
+        auto event = ::epoll_event{}; event.events = events; event.data.fd = descriptor;
+        if (0 != ::epoll_ctl(mEpoll.get(), EPOLL_CTL_ADD, descriptor, &event))
+            throw PURE_CXX_POSIX_EXCEPTION_MAKE(::std::runtime_error{"epoll_ctl(EPOLL_CTL_ADD) failure: " + utils::errorCodeToString()});
+        mHandlers[descriptor] = ::std::make_shared<Handler>(::std::move(handler));
+    }
+
+    inline auto Type::remove(int descriptor) noexcept(false) {
+        if (0 == mHandlers.erase(descriptor)) return;
+        if (0 != ::epoll_ctl(mEpoll.get(), EPOLL_CTL_DEL, descriptor, nullptr))
+            throw PURE_CXX_POSIX_EXCEPTION_MAKE(::std::runtime_error{"epoll_ctl(EPOLL_CTL_DEL) failure: " + utils::errorCodeToString()});
+    }
+
+    inline auto Type::run() noexcept(false) {
+        ::std::array<::epoll_event, 16> events;
+        mCondition = true;
+        while (mCondition) {
+            auto const count = ::epoll_wait(mEpoll.get(), events.data(), static_cast<int>(events.size()), -1);
+            if (0 > count) {
+                if (EINTR == errno) continue;
+                throw PURE_CXX_POSIX_EXCEPTION_MAKE(::std::runtime_error{"epoll_wait() failure: " + utils::errorCodeToString()});
+            }
+            for (auto index = 0; mCondition && (index < count); ++index) {
+                auto const iterator = mHandlers.find(events[index].data.fd);
+                if (mHandlers.end() == iterator) continue;
+                auto const handler = iterator->second;
+                (*handler)(events[index].events);
+            }
+        }
+    }
+
+namespace signals {
+
+    inline static auto block(::std::initializer_list<int> signals) noexcept(false) {
+        ::sigset_t set; ::sigemptyset(&set);
+        for (auto const id : signals) ::sigaddset(&set, id);
+        auto const code = ::pthread_sigmask(SIG_BLOCK, &set, nullptr);
+        if (0 != code) throw PURE_CXX_POSIX_EXCEPTION_MAKE(::std::runtime_error{"pthread_sigmask() failure: " + utils::errorCodeToString(code)});
+        return set;
+    }
+
+    // blocks the signals for the calling thread and all threads started later
+    inline static auto make(::std::initializer_list<int> signals) noexcept(false) {
+        auto const set = block(::std::move(signals));
+        auto &&descriptor = Descriptor{::signalfd(-1, &set, SFD_NONBLOCK | SFD_CLOEXEC)};
+        if (! descriptor) throw PURE_CXX_POSIX_EXCEPTION_MAKE(::std::runtime_error{"signalfd() failure: " + utils::errorCodeToString()});
+        return ::std::move(descriptor);
+    }
+
+    // returns 0 when nothing is pending
+    inline static int read(Descriptor const &descriptor) noexcept(false) {
+        auto info = ::signalfd_siginfo{};
+        auto const size = ::read(descriptor.get(), &info, sizeof(info));
+        if (static_cast<::ssize_t>(sizeof(info)) == size) return static_cast<int>(info.ssi_signo);
+        if ((0 > size) && (EAGAIN == errno)) return 0;
+        throw PURE_CXX_POSIX_EXCEPTION_MAKE(::std::runtime_error{"signalfd read() failure: " + utils::errorCodeToString()});
+    }
+
+} // namespace signals
+
+namespace timer {
+
+    inline static auto make() noexcept(false) {
+        auto &&descriptor = Descriptor{::timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC)};
+        if (! descriptor) throw PURE_CXX_POSIX_EXCEPTION_MAKE(::std::runtime_error{"timerfd_create() failure: " + utils::errorCodeToString()});
+        return ::std::move(descriptor);
+    }
+
+    // one-shot, non-positive delay disarms the timer
+    inline static auto arm(Descriptor const &descriptor, double delay) noexcept(false) {
+        auto value = ::itimerspec{};
+        if (+0.0e+0 < delay) {
+            auto const seconds = ::std::floor(delay);
+            value.it_value.tv_sec = static_cast<decltype(value.it_value.tv_sec)>(seconds);
+            value.it_value.tv_nsec = static_cast<decltype(value.it_value.tv_nsec)>((delay - seconds) * 1.0e+9);
+            if ((0 == value.it_value.tv_sec) && (0 == value.it_value.tv_nsec)) value.it_value.tv_nsec = 1;
+        }
+        if (0 != ::timerfd_settime(descriptor.get(), 0, &value, nullptr))
+            throw PURE_CXX_POSIX_EXCEPTION_MAKE(::std::runtime_error{"timerfd_settime() failure: " + utils::errorCodeToString()});
+    }
+
+    inline static auto read(Descriptor const &descriptor) noexcept(false) {
+        auto expirations = ::std::uint64_t{0};
+        auto const size = ::read(descriptor.get(), &expirations, sizeof(expirations));
+        if (static_cast<::ssize_t>(sizeof(expirations)) == size) return expirations;
+        if ((0 > size) && (EAGAIN == errno)) return ::std::uint64_t{0};
+        throw PURE_CXX_POSIX_EXCEPTION_MAKE(::std::runtime_error{"timerfd read() failure: " + utils::errorCodeToString()});
+    }
+
+} // namespace timer
+
+namespace event {
+
+    inline static auto make() noexcept(false) {
+        auto &&descriptor = Descriptor{::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC)};
+        if (! descriptor) throw PURE_CXX_POSIX_EXCEPTION_MAKE(::std::runtime_error{"eventfd() failure: " + utils::errorCodeToString()});
+        return ::std::move(descriptor);
+    }
+
+    // async-signal-safe and callable from any thread
+    inline static auto notify(Descriptor const &descriptor) noexcept(true) {
+        auto const value = ::std::uint64_t{1};
+        return static_cast<::ssize_t>(sizeof(value)) == ::write(descriptor.get(), &value, sizeof(value));
+    }
+
+    inline static auto read(Descriptor const &descriptor) noexcept(false) {
+        auto value = ::std::uint64_t{0};
+        auto const size = ::read(descriptor.get(), &value, sizeof(value));
+        if (static_cast<::ssize_t>(sizeof(value)) == size) return value;
+        if ((0 > size) && (EAGAIN == errno)) return ::std::uint64_t{0};
+        throw PURE_CXX_POSIX_EXCEPTION_MAKE(::std::runtime_error{"eventfd read() failure: " + utils::errorCodeToString()});
+    }
+
+} // namespace event
+} // namespace reactor
+
+    using Reactor = reactor::Type;
+
+} // namespace pure_cxx_posix
+
+#else
+#error "__cplusplus not defined. c++14 or hight is required"
+#endif // defined(__cplusplus) && (201402L <= __cplusplus)
+#endif // PURE_CXX_POSIX_REACTOR_HPP
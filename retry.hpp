@@ -0,0 +1,135 @@
+#ifndef PURE_CXX_POSIX_RETRY_HPP
+#define PURE_CXX_POSIX_RETRY_HPP
+#pragma once
+#if defined(__cplusplus) && (201402L <= __cplusplus)
+
+#include <cstdint>
+
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <utility>
+#include <unordered_map>
+
+#include <sys/stat.h>
+
+#include "utils.hpp"
+
+
+namespace pure_cxx_posix {
+namespace retry {
+
+    using Clock = ::std::chrono::steady_clock;
+
+    // what a file was when it failed, a file that differs from it is a new file
+    struct Identity final {
+        ::std::uint64_t device = 0, inode = 0, size = 0;
+        ::std::int64_t mtime = 0;
+    };
+
+    inline static auto operator == (Identity const &a, Identity const &b) noexcept(true) {
+        return (a.device == b.device) && (a.inode == b.inode) && (a.size == b.size) && (a.mtime == b.mtime);
+    }
+
+    template <class T> inline static auto identify(T const &path, Identity &identity) noexcept(true) {
+        struct ::stat information;
+        if (0 != ::stat(path.c_str(), &information)) return false;
+        identity.device = information.st_dev; identity.inode = information.st_ino;
+        identity.size = static_cast<::std::uint64_t>(information.st_size);
+        identity.mtime = ::std::int64_t{information.st_mtim.tv_sec} * 1000000000 + information.st_mtim.tv_nsec;
+        return true;
+    }
+
+    enum class Verdict { Attempt, Defer, Quarantine };
+
+    // failed files of a route by name: attempts are deferred with exponential backoff,
+    // after the limit a file is quarantined, or skipped until it changes;
+    // identify(Identity &) describes the file as it is now, false when it is gone
+    struct Type final {
+        using Interval = double;
+
+        // files without a failure are admitted without the lock
+        template <class T> inline auto verdict(::std::string const &name, T &&identify) noexcept(false);
+
+        // delay of the first retry, it doubles with every failure up to 64 times
+        template <class T> inline auto failed(::std::string const &name, T &&identify, Interval base, ::std::size_t limit) noexcept(false);
+
+        inline auto succeeded(::std::string const &name) noexcept(false);
+
+        // after a scan that asked for the verdict of every listed file: forgets files that weren't listed
+        inline auto sweep() noexcept(false);
+
+        inline auto size() const noexcept(true) { return mSize.load(::std::memory_order_acquire); }
+
+    private:
+        struct Entry final {
+            Identity identity;
+            ::std::size_t failures = 0;
+            Clock::time_point next;
+            bool exhausted = false;
+            ::std::size_t generation = 0;
+        };
+
+        ::std::size_t mGeneration = 0;
+        ::std::mutex mMutex;
+        ::std::unordered_map<::std::string, Entry> mEntries;
+        ::std::atomic<::std::size_t> mSize{0};
+    };
+
+    template <class T> inline auto Type::verdict(::std::string const &name, T &&identify) noexcept(false) {
+        if (0 == size()) return Verdict::Attempt;
+        auto const lock = utils::makeUniqueLock(mMutex); utils::unused(lock);
+        auto const entry = mEntries.find(name);
+        if (mEntries.end() == entry) return Verdict::Attempt;
+        entry->second.generation = mGeneration;
+        auto &&identity = Identity{};
+        if ((! identify(identity)) || (! (identity == entry->second.identity))) {
+            mEntries.erase(entry); mSize.store(mEntries.size(), ::std::memory_order_release);
+            return Verdict::Attempt;
+        }
+        if (entry->second.exhausted) return Verdict::Defer;
+        return (Clock::now() < entry->second.next) ? Verdict::Defer : Verdict::Attempt;
+    }
+
+    template <class T> inline auto Type::failed(::std::string const &name, T &&identify, Interval base, ::std::size_t limit) noexcept(false) {
+        auto &&identity = Identity{};
+        if (! identify(identity)) return Verdict::Attempt;
+        auto const lock = utils::makeUniqueLock(mMutex); utils::unused(lock);
+        auto &entry = mEntries[name];
+        if (! (identity == entry.identity)) { entry = Entry{}; entry.identity = identity; }
+        ++entry.failures; entry.generation = mGeneration;
+        auto const shift = ::std::min<::std::size_t>(entry.failures - 1, 6);
+        entry.next = Clock::now() + ::std::chrono::duration_cast<Clock::duration>(::std::chrono::duration<Interval>{base * static_cast<Interval>(::std::size_t{1} << shift)});
+        mSize.store(mEntries.size(), ::std::memory_order_release);
+        if ((0 == limit) || (entry.failures < limit)) return Verdict::Defer;
+        entry.exhausted = true;
+        return Verdict::Quarantine;
+    }
+
+    inline auto Type::succeeded(::std::string const &name) noexcept(false) {
+        if (0 == size()) return;
+        auto const lock = utils::makeUniqueLock(mMutex); utils::unused(lock);
+        mEntries.erase(name); mSize.store(mEntries.size(), ::std::memory_order_release);
+    }
+
+    inline auto Type::sweep() noexcept(false) {
+        auto const lock = utils::makeUniqueLock(mMutex); utils::unused(lock);
+        for (auto iterator = mEntries.begin(); mEntries.end() != iterator;) {
+            if (mGeneration == iterator->second.generation) ++iterator;
+            else iterator = mEntries.erase(iterator);
+        }
+        ++mGeneration;
+        mSize.store(mEntries.size(), ::std::memory_order_release);
+    }
+
+} // namespace retry
+
+    using Retry = retry::Type;
+
+} // namespace pure_cxx_posix
+
+#else
+#error "__cplusplus not defined. c++14 or hight is required"
+#endif // defined(__cplusplus) && (201402L <= __cplusplus)
+#endif // PURE_CXX_POSIX_RETRY_HPP
@@ -0,0 +1,137 @@
+#ifndef PURE_CXX_POSIX_SEGMENT_HPP
+#define PURE_CXX_POSIX_SEGMENT_HPP
+#pragma once
+#if defined(__cplusplus) && (201402L <= __cplusplus)
+
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+
+#include <string>
+#include <utility>
+#include <system_error>
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "checksum.hpp"
+#include "descriptor.hpp"
+
+
+namespace pure_cxx_posix {
+namespace segment {
+
+    // a segment packs small files into one append-only file: every file is a record, a header
+    // followed by its relative name and data; sealing appends the index, one entry per record,
+    // and the trailer as the last bytes of the file; integers are in host order, every part
+    // starts at a multiple of 8 bytes
+    struct Record final {
+        constexpr static ::std::uint32_t const signature = 0x52584350; // "PCXR"
+
+        ::std::uint32_t magic = signature, length = 0;
+        ::std::uint64_t size = 0, checksum = 0;
+    };
+
+    struct Entry final {
+        ::std::uint64_t record = 0, size = 0, checksum = 0;
+        ::std::uint32_t length = 0, reserved = 0;
+    };
+
+    struct Trailer final {
+        constexpr static ::std::uint32_t const signature = 0x53584350; // "PCXS"
+        constexpr static ::std::uint32_t const revision = 1;
+
+        ::std::uint32_t magic = signature, version = revision;
+        ::std::uint64_t count = 0, index = 0, checksum = 0; // checksum of the index
+    };
+
+    // sealed segments are named "<seconds>-<pid>-<sequence>.seg", open ones are hidden until sealed
+    constexpr static char const suffix[] = ".seg";
+    constexpr static char const pending[] = ".open";
+
+    inline static constexpr auto align(::std::uint64_t value) noexcept(true) { return (value + 7) & ~::std::uint64_t{7}; }
+
+    // where the name and the data of a record start
+    inline static constexpr auto name(::std::uint64_t record) noexcept(true) { return record + sizeof(Record); }
+    inline static constexpr auto data(::std::uint64_t record, ::std::uint32_t length) noexcept(true) { return align(name(record) + length); }
+    inline static constexpr auto end(::std::uint64_t record, ::std::uint32_t length, ::std::uint64_t size) noexcept(true) { return align(data(record, length) + size); }
+
+    // one packed file, pointing into the mapping of its reader
+    struct View final {
+        char const *name = nullptr;
+        ::std::size_t length = 0;
+        char const *data = nullptr;
+        ::std::uint64_t size = 0, checksum = 0;
+
+        inline auto key() const noexcept(false) { return ::std::string{name, length}; }
+        inline auto verify() const noexcept(true) { return checksum::make(data, static_cast<::std::size_t>(size)) == checksum; }
+    };
+
+    // maps a sealed segment read-only, entries are views into the mapping and live as long as the reader
+    struct Reader final {
+        inline auto open(char const *path, ::std::error_code &code) noexcept(true);
+
+        inline auto size() const noexcept(true) { return static_cast<::std::size_t>(mTrailer.count); }
+
+        inline auto operator [] (::std::size_t index) const noexcept(true) {
+            auto const &entry = reinterpret_cast<Entry const *>(mBase + mTrailer.index)[index];
+            return View{mBase + name(entry.record), entry.length, mBase + data(entry.record, entry.length), entry.size, entry.checksum};
+        }
+
+        Reader() = default;
+        inline ~Reader() noexcept(true) { close(); }
+
+        Reader(Reader const &) = delete;
+        Reader & operator = (Reader const &) = delete;
+
+    private:
+        char const *mBase = nullptr;
+        ::std::size_t mLength = 0;
+        Trailer mTrailer;
+
+        inline auto close() noexcept(true) -> void {
+            if (nullptr != mBase) ::munmap(const_cast<char *>(mBase), mLength);
+            mBase = nullptr; mLength = 0; mTrailer = Trailer{};
+        }
+    };
+
+    inline auto Reader::open(char const *path, ::std::error_code &code) noexcept(true) {
+        close();
+        auto const fail = [this, &code] (int value) { close(); code.assign(value, ::std::generic_category()); return false; };
+        auto const descriptor = Descriptor{::open(path, O_RDONLY | O_CLOEXEC)};
+        if (! descriptor) return fail(errno);
+        struct ::stat information;
+        if (0 != ::fstat(descriptor.get(), &information)) return fail(errno);
+        auto const length = static_cast<::std::uint64_t>(information.st_size);
+        if (length < sizeof(Trailer)) return fail(EBADMSG);
+        auto const map = ::mmap(nullptr, static_cast<::std::size_t>(length), PROT_READ, MAP_SHARED, descriptor.get(), 0);
+        if (MAP_FAILED == map) return fail(errno);
+        mBase = static_cast<char const *>(map); mLength = static_cast<::std::size_t>(length);
+
+        // every entry has to point at a record inside the file that agrees with it
+        ::std::memcpy(&mTrailer, mBase + length - sizeof(Trailer), sizeof(Trailer));
+        if ((Trailer::signature != mTrailer.magic) || (Trailer::revision != mTrailer.version)) return fail(EBADMSG);
+        auto const limit = length - sizeof(Trailer);
+        if ((limit < mTrailer.index) || ((limit - mTrailer.index) / sizeof(Entry) != mTrailer.count) || (0 != mTrailer.index % 8)) return fail(EBADMSG);
+        if (checksum::make(mBase + mTrailer.index, static_cast<::std::size_t>(mTrailer.count * sizeof(Entry))) != mTrailer.checksum) return fail(EBADMSG);
+        for (auto index = ::std::size_t{0}; index < size(); ++index) {
+            auto const &entry = reinterpret_cast<Entry const *>(mBase + mTrailer.index)[index];
+            if ((mTrailer.index < entry.record) || (mTrailer.index - entry.record < sizeof(Record)) || (0 != entry.record % 8)) return fail(EBADMSG);
+            // no sums of sizes from the file: an entry.size near 2^64 wraps end() back inside it
+            if ((mTrailer.index < data(entry.record, entry.length)) || (mTrailer.index - data(entry.record, entry.length) < entry.size)) return fail(EBADMSG);
+            auto record = Record{}; ::std::memcpy(&record, mBase + entry.record, sizeof(record));
+            if ((Record::signature != record.magic) || (record.length != entry.length) || (record.size != entry.size)) return fail(EBADMSG);
+        }
+        code.clear();
+        return true;
+    }
+
+} // namespace segment
+} // namespace pure_cxx_posix
+
+#else
+#error "__cplusplus not defined. c++14 or hight is required"
+#endif // defined(__cplusplus) && (201402L <= __cplusplus)
+#endif // PURE_CXX_POSIX_SEGMENT_HPP
@@ -0,0 +1,136 @@
+#ifndef PURE_CXX_POSIX_SHARD_HPP
+#define PURE_CXX_POSIX_SHARD_HPP
+#pragma once
+#if defined(__cplusplus) && (201402L <= __cplusplus)
+
+#include <cerrno>
+#include <cstdint>
+
+#include <string>
+#include <vector>
+#include <utility>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#include "pid.hpp"
+#include "logger.hpp"
+#include "context.hpp"
+#include "exception.hpp"
+#include "descriptor.hpp"
+#include "utils.hpp"
+#include "stdfs.hpp"
+
+
+namespace pure_cxx_posix {
+namespace shard {
+
+    using Index = ::std::int32_t;
+
+    inline static ::std::string path(Index index) noexcept(false) {
+        auto const &&name = utils::copy(Context::instance().name);
+        return stdfs::absolute((name.empty() ? ::std::string{utils::defaultName()} : ::std::move(name)) + ".shard." + ::std::to_string(index), "/var/run");
+    }
+
+    template <class T> inline static auto hash(T const &name) noexcept(true) {
+        auto value = ::std::uint64_t{14695981039346656037ull};
+        for (auto const symbol : name) { value ^= static_cast<unsigned char>(symbol); value *= ::std::uint64_t{1099511628211ull}; }
+        return value;
+    }
+
+    // jump consistent hash: growing the shard count only moves names into the new shards
+    inline static auto jump(::std::uint64_t key, Index count) noexcept(true) {
+        auto bucket = ::std::int64_t{-1}, next = ::std::int64_t{0};
+        while (next < count) {
+            bucket = next;
+            key = key * ::std::uint64_t{2862933555777941757ull} + 1;
+            next = static_cast<::std::int64_t>(static_cast<double>(bucket + 1) * (static_cast<double>(::std::int64_t{1} << 31) / static_cast<double>((key >> 33) + 1)));
+        }
+        return static_cast<Index>(bucket);
+    }
+
+    // set of shard locks held by this instance: one primary shard kept for the whole lifetime
+    // and orphaned shards adopted for a single scan, so a restarted holder can take its shard back
+    struct Type final {
+        using Index = shard::Index;
+
+        inline auto count() const noexcept(true) { return static_cast<Index>(mLocks.size()); }
+        inline auto primary() const noexcept(true) { return mPrimary; }
+
+        inline auto owns(Index index) const noexcept(true) { return (0 <= index) && (index < count()) && static_cast<bool>(mLocks[index]); }
+        template <class T> inline auto accepts(T const &name) const noexcept(true) { return mLocks.empty() || owns(jump(hash(name), count())); }
+
+        // returns true when the set of owned shards differs from the one of the previous scan
+        inline auto acquire() noexcept(false);
+        inline auto release() noexcept(true);
+
+        inline explicit Type(Index count = 0) noexcept(false) : mLocks(static_cast<::std::size_t>(0 < count ? count : 0)) {}
+
+    private:
+        Index mPrimary = -1;
+        ::std::vector<Descriptor> mLocks;
+        ::std::vector<bool> mAdopted = ::std::vector<bool>(mLocks.size(), false);
+        ::std::vector<bool> mPrevious = mAdopted; // adopted for the previous scan
+
+        inline static auto tryLock(Index index) noexcept(false);
+    };
+
+    inline auto Type::tryLock(Index index) noexcept(false) {
+        auto const &&path = shard::path(index);
+        // whoever can open a shard file can lock it and hold the shard, only the owner may
+        auto &&descriptor = Descriptor{::open(path.c_str(), O_CREAT | O_RDWR | O_CLOEXEC, 0600)};
+        if (! descriptor) throw PURE_CXX_POSIX_EXCEPTION_MAKE(::std::runtime_error{"failed to open shard file " + path + ": " + utils::errorCodeToString()});
+        // files left by a version that created them writable for everybody
+        ::fchmod(descriptor.get(), 0600);
+        if (0 != ::lockf(descriptor.get(), F_TLOCK, 0)) {
+            auto const code = errno;
+            if ((EAGAIN != code) && (EACCES != code))
+                throw PURE_CXX_POSIX_EXCEPTION_MAKE(::std::runtime_error{"failed to lockf() shard file " + path + ": " + utils::errorCodeToString(code)});
+            descriptor.reset();
+        }
+        return ::std::move(descriptor);
+    }
+
+    inline auto Type::acquire() noexcept(false) {
+        auto changed = false;
+        for (auto index = Index{0}; index < count(); ++index) {
+            if (owns(index)) continue;
+            auto &&descriptor = tryLock(index);
+            if (! descriptor) {
+                if (mPrevious[index]) { changed = true; Logger::instance() << "Shard #" << index << " of " << count() << " is taken back by its holder"; }
+                continue;
+            }
+            if (0 > mPrimary) {
+                changed = true;
+                if (0 != ::ftruncate(descriptor.get(), 0)) throw PURE_CXX_POSIX_EXCEPTION_MAKE(::std::runtime_error{
+                    "failed to ftruncate() shard file: " + utils::errorCodeToString()
+                });
+                pid::write(descriptor.get(), ::getpid());
+                mPrimary = index;
+                Logger::instance() << "Shard #" << index << " of " << count() << " is mine now";
+            } else {
+                mAdopted[index] = true;
+                if (! mPrevious[index]) { changed = true; Logger::instance() << "Shard #" << index << " of " << count() << " is orphaned, adopting it"; }
+            }
+            mLocks[index] = ::std::move(descriptor);
+        }
+        return changed;
+    }
+
+    inline auto Type::release() noexcept(true) {
+        mPrevious = mAdopted;
+        for (auto index = Index{0}; index < count(); ++index) if (mAdopted[index]) { mLocks[index].reset(); mAdopted[index] = false; }
+    }
+
+} // namespace shard
+
+    using Shards = shard::Type;
+
+} // namespace pure_cxx_posix
+
+#else
+#error "__cplusplus not defined. c++14 or hight is required"
+#endif // defined(__cplusplus) && (201402L <= __cplusplus)
+#endif // PURE_CXX_POSIX_SHARD_HPP
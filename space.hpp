@@ -0,0 +1,115 @@
+#ifndef PURE_CXX_POSIX_SPACE_HPP
+#define PURE_CXX_POSIX_SPACE_HPP
+#pragma once
+#if defined(__cplusplus) && (201402L <= __cplusplus)
+
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <cstdint>
+#include <algorithm>
+
+#include <sys/statvfs.h>
+
+#include "utils.hpp"
+
+
+namespace pure_cxx_posix {
+namespace space {
+
+    // free bytes of the destination as admission sees them: statvfs at most every 100 ms, less the
+    // sizes of the copies in flight and of the ones written since that statvfs
+    struct Type final {
+        constexpr static double const period = +1.0e-1;
+
+        // low is the free space admission keeps, the next statvfs is taken at once
+        inline auto configure(::std::string const &directory, ::std::uint64_t low) noexcept(false) {
+            auto const lock = utils::makeUniqueLock(mMutex); utils::unused(lock);
+            mDirectory = directory; mLow = low; mMeasured = false;
+        }
+
+        // reserves size bytes when at least low bytes stay free after them, false pauses admission;
+        // a destination that can't be measured admits everything
+        inline auto admit(::std::uint64_t size) noexcept(true) {
+            auto const lock = utils::makeUniqueLock(mMutex); utils::unused(lock);
+            refresh();
+            if (mMeasured && (mFree < mReserved + size + mLow)) return false;
+            mReserved += size;
+            publish();
+            return true;
+        }
+
+        inline auto release(::std::uint64_t size, bool written) noexcept(true) {
+            auto const lock = utils::makeUniqueLock(mMutex); utils::unused(lock);
+            mReserved -= ::std::min(mReserved, size);
+            if (written) mFree -= ::std::min(mFree, size);
+            publish();
+        }
+
+        // after a copy was refused or ran out of space: whether the destination itself is below low,
+        // measured afresh, or just that file doesn't fit; a destination that can't be measured is full
+        inline auto exhausted() noexcept(true) {
+            auto const lock = utils::makeUniqueLock(mMutex); utils::unused(lock);
+            mMeasured = false;
+            refresh();
+            return (! mMeasured) || (0 == mFree) || (mFree < mReserved + mLow);
+        }
+
+        // what admission counted as free at its last change, for stats: neither the lock nor statvfs,
+        // the reactor thread must not wait for a hung destination
+        inline auto available() const noexcept(true) { return mAvailable.load(::std::memory_order_relaxed); }
+
+    private:
+        using Clock = ::std::chrono::steady_clock;
+
+        ::std::mutex mMutex;
+        ::std::string mDirectory;
+        ::std::uint64_t mLow = 0, mFree = 0, mReserved = 0;
+        ::std::atomic<::std::uint64_t> mAvailable{0};
+        bool mMeasured = false;
+        Clock::time_point mStamp;
+
+        inline auto refresh() noexcept(true) -> void {
+            auto const now = Clock::now();
+            if (mMeasured && (::std::chrono::duration<double>{now - mStamp}.count() < period)) return;
+            struct ::statvfs information;
+            mMeasured = (! mDirectory.empty()) && (0 == ::statvfs(mDirectory.c_str(), &information));
+            if (! mMeasured) return;
+            mFree = static_cast<::std::uint64_t>(information.f_bavail) * information.f_frsize;
+            mStamp = now;
+            publish();
+        }
+
+        inline auto publish() noexcept(true) -> void { mAvailable.store(mFree - ::std::min(mFree, mReserved), ::std::memory_order_relaxed); }
+    };
+
+    // space of one copy, admitted on construction and given back on destruction;
+    // written tells that the bytes are on the destination now
+    struct Reservation final {
+        bool written = false;
+
+        inline auto admitted() const noexcept(true) { return mAdmitted; }
+
+        inline explicit Reservation(Type *space, ::std::uint64_t size) noexcept(true) : mSpace{space}, mSize{size}, mAdmitted{(nullptr == space) || space->admit(size)} {}
+        inline ~Reservation() noexcept(true) { if ((nullptr != mSpace) && mAdmitted) mSpace->release(mSize, written); }
+
+        Reservation(Reservation const &) = delete;
+        Reservation & operator = (Reservation const &) = delete;
+
+    private:
+        Type *mSpace;
+        ::std::uint64_t mSize;
+        bool mAdmitted;
+    };
+
+} // namespace space
+
+    using Space = space::Type;
+
+} // namespace pure_cxx_posix
+
+#else
+#error "__cplusplus not defined. c++14 or hight is required"
+#endif // defined(__cplusplus) && (201402L <= __cplusplus)
+#endif // PURE_CXX_POSIX_SPACE_HPP
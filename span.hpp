@@ -0,0 +1,129 @@
+#ifndef PURE_CXX_POSIX_SPAN_HPP
+#define PURE_CXX_POSIX_SPAN_HPP
+#pragma once
+#if defined(__cplusplus) && (201402L <= __cplusplus)
+
+#include <array>
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <utility>
+#include <algorithm>
+
+#include "utils.hpp"
+
+
+namespace pure_cxx_posix {
+namespace span {
+
+    using Clock = ::std::chrono::steady_clock;
+
+    // layout is the destination subdirectory, or the connection of a stream destination
+    enum Stage : ::std::size_t { Layout = 0, Log, Open, Checksum, Copy, Commit, Unlink, Count };
+
+    inline static auto label(Stage stage) noexcept(true) {
+        static char const * const labels[] = {"layout", "log", "open", "checksum", "copy", "commit", "unlink"};
+        return labels[stage];
+    }
+
+    // per-stage durations of one move in nanoseconds, a disabled span never reads the clock
+    struct Type final {
+        ::std::string name;
+        ::std::array<::std::uint64_t, Stage::Count> stages{};
+        ::std::uint64_t total = 0;
+        char const *failure = nullptr;
+
+        inline auto enabled() const noexcept(true) { return mEnabled; }
+
+        // time since the previous mark is accounted to stage
+        inline auto mark(Stage stage) noexcept(true) {
+            if (! mEnabled) return;
+            auto const now = Clock::now();
+            stages[stage] += elapsed(mLast, now); mLast = now;
+        }
+
+        inline auto finish(char const *operation = nullptr) noexcept(true) {
+            if (! mEnabled) return;
+            total = elapsed(mStart, Clock::now()); failure = operation;
+        }
+
+        Type() = default;
+        inline explicit Type(bool enabled) noexcept(true) : mEnabled{enabled} { if (enabled) mStart = mLast = Clock::now(); }
+
+    private:
+        bool mEnabled = false;
+        Clock::time_point mStart, mLast;
+
+        inline static ::std::uint64_t elapsed(Clock::time_point from, Clock::time_point to) noexcept(true) {
+            return static_cast<::std::uint64_t>(::std::chrono::duration_cast<::std::chrono::nanoseconds>(to - from).count());
+        }
+    };
+
+    // slowest spans since the last take(), kept in a min-heap by total; a span faster than
+    // the fastest kept one is dropped by an atomic compare before the lock is taken
+    struct Recorder final {
+        using Spans = ::std::vector<Type>;
+
+        inline auto enabled() const noexcept(true) { return 0 < mCapacity.load(::std::memory_order_acquire); }
+
+        inline auto resize(::std::size_t capacity) noexcept(false) {
+            auto const lock = utils::makeUniqueLock(mMutex); utils::unused(lock);
+            mCapacity.store(capacity, ::std::memory_order_release);
+            while (capacity < mHeap.size()) { ::std::pop_heap(mHeap.begin(), mHeap.end(), faster); mHeap.pop_back(); }
+            threshold();
+        }
+
+        inline auto record(Type &&span) noexcept(true) {
+            if ((! span.enabled()) || (span.total <= mThreshold.load(::std::memory_order_acquire))) return;
+            try {
+                auto const lock = utils::makeUniqueLock(mMutex); utils::unused(lock);
+                auto const capacity = mCapacity.load(::std::memory_order_acquire);
+                if (mHeap.size() < capacity) mHeap.push_back(::std::move(span));
+                else if ((0 < capacity) && (mHeap.front().total < span.total)) {
+                    ::std::pop_heap(mHeap.begin(), mHeap.end(), faster);
+                    mHeap.back() = ::std::move(span);
+                } else return;
+                ::std::push_heap(mHeap.begin(), mHeap.end(), faster);
+                threshold();
+            } catch(...) {}
+        }
+
+        // slowest first, the recorder starts over
+        inline auto take() noexcept(false) {
+            auto &&result = Spans{};
+            {
+                auto const lock = utils::makeUniqueLock(mMutex); utils::unused(lock);
+                result.swap(mHeap);
+                threshold();
+            }
+            ::std::sort(result.begin(), result.end(), faster);
+            return ::std::move(result);
+        }
+
+    private:
+        ::std::mutex mMutex;
+        Spans mHeap;
+        ::std::atomic<::std::size_t> mCapacity{0};
+        ::std::atomic<::std::uint64_t> mThreshold{0};
+
+        inline static bool faster(Type const &a, Type const &b) noexcept(true) { return a.total > b.total; }
+
+        inline void threshold() noexcept(true) {
+            auto const full = (0 < mCapacity.load(::std::memory_order_acquire)) && (mCapacity.load(::std::memory_order_acquire) <= mHeap.size());
+            mThreshold.store(full ? mHeap.front().total : 0, ::std::memory_order_release);
+        }
+    };
+
+} // namespace span
+
+    using Span = span::Type;
+
+} // namespace pure_cxx_posix
+
+#else
+#error "__cplusplus not defined. c++14 or hight is required"
+#endif // defined(__cplusplus) && (201402L <= __cplusplus)
+#endif // PURE_CXX_POSIX_SPAN_HPP
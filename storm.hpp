@@ -0,0 +1,119 @@
+#ifndef PURE_CXX_POSIX_STORM_HPP
+#define PURE_CXX_POSIX_STORM_HPP
+#pragma once
+#if defined(__cplusplus) && (201402L <= __cplusplus)
+
+#include <cerrno>
+#include <cstdint>
+
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <vector>
+#include <utility>
+#include <algorithm>
+
+#include "utils.hpp"
+
+
+namespace pure_cxx_posix {
+namespace storm {
+
+    using Clock = ::std::chrono::steady_clock;
+
+    // a failure is classified by its errno and the operation or throw site that produced it,
+    // sites are short ("copy_file_range", "main.cpp:185"), so a key never allocates
+    struct Key final {
+        int code = 0;
+        ::std::string site;
+    };
+
+    inline static auto operator == (Key const &a, Key const &b) noexcept(true) { return (a.code == b.code) && (a.site == b.site); }
+
+    template <class T> inline static auto classify(T const &status) noexcept(false) { return Key{status.code.value(), status.operation}; }
+
+    // exceptions are classified by their throw site and the errno the context took there,
+    // by the time a handler runs the unwinding has overwritten errno
+    template <class T> inline static auto site(T const &context) noexcept(false) {
+        auto const slash = context.file.rfind('/');
+        return Key{context.code, ((::std::string::npos == slash) ? context.file : context.file.substr(slash + 1)) + ":" + context.line};
+    }
+
+    // identical failures are coalesced: the first one in an interval is reported in full,
+    // the rest are counted and summarized once the interval passed; a streak of the same
+    // key without a success in between marks the route as failing systemically
+    struct Type final {
+        using Interval = double;
+
+        struct Summary final { Key key; ::std::size_t count = 0; ::std::string last; };
+
+        // true when the occurrence has to be reported in full
+        inline auto admit(Key &&key, ::std::string const &example, Interval interval) noexcept(false);
+
+        inline auto success() noexcept(true) { if (0 < mStreak.load(::std::memory_order_relaxed)) mStreak.store(0, ::std::memory_order_relaxed); }
+        inline auto streak() const noexcept(true) { return mStreak.load(::std::memory_order_relaxed); }
+
+        // a scan after a pause probes the route: one more failure of the same kind stops it again
+        inline auto rearm(::std::size_t threshold) noexcept(true) {
+            if ((0 < threshold) && (threshold <= mStreak.load(::std::memory_order_relaxed))) mStreak.store(threshold - 1, ::std::memory_order_relaxed);
+        }
+
+        // keys whose interval passed with suppressed occurrences, they are reported in full again afterwards
+        inline auto expired(Interval interval) noexcept(false);
+
+    private:
+        constexpr static ::std::size_t const capacity = 64;
+
+        struct Entry final { Key key; Clock::time_point since; ::std::size_t suppressed = 0; ::std::string last; };
+
+        ::std::mutex mMutex;
+        ::std::vector<Entry> mEntries;
+        Key mLast;
+        ::std::atomic<::std::size_t> mStreak{0};
+
+        inline static auto passed(Clock::time_point since, Clock::time_point now, Interval interval) noexcept(true) {
+            return ::std::chrono::duration<Interval>{now - since}.count() >= interval;
+        }
+    };
+
+    inline auto Type::admit(Key &&key, ::std::string const &example, Interval interval) noexcept(false) {
+        auto const lock = utils::makeUniqueLock(mMutex); utils::unused(lock);
+        auto const now = Clock::now();
+        if (key == mLast) mStreak.fetch_add(1, ::std::memory_order_relaxed);
+        else { mLast = key; mStreak.store(1, ::std::memory_order_relaxed); }
+
+        auto const entry = ::std::find_if(mEntries.begin(), mEntries.end(), [&key] (auto const &item) { return item.key == key; });
+        if (mEntries.end() != entry) {
+            if (passed(entry->since, now, interval) && (0 == entry->suppressed)) { entry->since = now; return true; }
+            ++entry->suppressed; entry->last = example;
+            return false;
+        }
+        // a full table forgets its oldest key, the worst case is one more full report
+        if (! (mEntries.size() < capacity)) mEntries.erase(::std::min_element(mEntries.begin(), mEntries.end(), [] (auto const &a, auto const &b) { return a.since < b.since; }));
+        mEntries.push_back(Entry{::std::move(key), now, 0, {}});
+        return true;
+    }
+
+    inline auto Type::expired(Interval interval) noexcept(false) {
+        auto &&result = ::std::vector<Summary>{};
+        auto const lock = utils::makeUniqueLock(mMutex); utils::unused(lock);
+        auto const now = Clock::now();
+        for (auto iterator = mEntries.begin(); mEntries.end() != iterator;) {
+            if (! passed(iterator->since, now, interval)) { ++iterator; continue; }
+            if (0 < iterator->suppressed) result.push_back(Summary{iterator->key, iterator->suppressed, ::std::move(iterator->last)});
+            iterator = mEntries.erase(iterator);
+        }
+        return ::std::move(result);
+    }
+
+} // namespace storm
+
+    using Storm = storm::Type;
+
+} // namespace pure_cxx_posix
+
+#else
+#error "__cplusplus not defined. c++14 or hight is required"
+#endif // defined(__cplusplus) && (201402L <= __cplusplus)
+#endif // PURE_CXX_POSIX_STORM_HPP
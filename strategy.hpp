@@ -0,0 +1,134 @@
+#ifndef PURE_CXX_POSIX_STRATEGY_HPP
+#define PURE_CXX_POSIX_STRATEGY_HPP
+#pragma once
+#if defined(__cplusplus) && (201402L <= __cplusplus)
+
+#include <map>
+#include <array>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <utility>
+
+#include "utils.hpp"
+
+
+namespace pure_cxx_posix {
+namespace strategy {
+
+    // ways the engine can copy the data of one file, see engine::copy
+    enum Method : ::std::size_t { Buffer = 0, Sendfile, Range, Count };
+
+    inline static auto label(Method method) noexcept(true) {
+        static char const * const labels[] = {"buffer", "sendfile", "range"};
+        return labels[method];
+    }
+
+    // Count for an unknown label
+    inline static auto parse(::std::string const &value) noexcept(true) {
+        for (auto method = ::std::size_t{0}; method < Method::Count; ++method) if (value == label(static_cast<Method>(method))) return static_cast<Method>(method);
+        return Method::Count;
+    }
+
+    // up to 64 KiB, 1 MiB, 16 MiB, 256 MiB and above
+    constexpr static ::std::size_t const classes = 5;
+
+    inline static auto classOf(::std::uint64_t size) noexcept(true) {
+        auto index = ::std::size_t{0};
+        for (auto limit = ::std::uint64_t{0x10000}; (index + 1 < classes) && (limit <= size); limit <<= 4) ++index;
+        return index;
+    }
+
+    // the fastest method per (source device, destination device, size class): every method is tried
+    // a few times first, calibration seeds that, then throughput is a moving average of live copies
+    // and every 32nd copy of a class goes to the next method so a change of the devices shows up
+    struct Table final {
+        constexpr static ::std::size_t const trials = 2;
+        constexpr static ::std::size_t const period = 32;
+
+        using Device = ::std::uint64_t;
+
+        inline auto choose(Device source, Device destination, ::std::uint64_t size) noexcept(false);
+
+        // method is what the copy was started with, used what it ended up with after fallbacks
+        inline auto record(Device source, Device destination, ::std::uint64_t size, Method method, Method used, ::std::uint64_t nanoseconds) noexcept(false);
+
+        // true once for every pair, the caller calibrates it
+        inline auto fresh(Device source, Device destination) noexcept(false) {
+            auto const lock = utils::makeUniqueLock(mMutex); utils::unused(lock);
+            return mPairs.emplace(Key{source, destination}, Pair{}).second;
+        }
+
+        // the current choice per size class of every pair, "source destination method..." lines
+        inline auto describe() noexcept(false);
+
+    private:
+        struct Cell final { double rate = +0.0e+0; ::std::size_t samples = 0; };
+        struct Class final { ::std::array<Cell, Method::Count> cells{}; ::std::size_t copies = 0; };
+        struct Pair final { ::std::array<Class, classes> sizes{}; ::std::array<bool, Method::Count> unusable{}; };
+        using Key = ::std::pair<Device, Device>;
+
+        ::std::mutex mMutex;
+        ::std::map<Key, Pair> mPairs;
+
+        // sendfile until something was measured
+        inline static auto best(Pair const &pair, Class const &entry) noexcept(true) {
+            auto result = Method::Sendfile;
+            auto rate = -1.0e+0;
+            for (auto method = ::std::size_t{0}; method < Method::Count; ++method) {
+                auto const &cell = entry.cells[method];
+                if (pair.unusable[method] || (0 == cell.samples) || (cell.rate <= rate)) continue;
+                result = static_cast<Method>(method); rate = cell.rate;
+            }
+            return result;
+        }
+    };
+
+    inline auto Table::choose(Device source, Device destination, ::std::uint64_t size) noexcept(false) {
+        auto const lock = utils::makeUniqueLock(mMutex); utils::unused(lock);
+        auto &pair = mPairs[Key{source, destination}];
+        auto &entry = pair.sizes[classOf(size)];
+        auto const copies = entry.copies++;
+        for (auto method = ::std::size_t{0}; method < Method::Count; ++method) {
+            if ((! pair.unusable[method]) && (entry.cells[method].samples < trials)) return static_cast<Method>(method);
+        }
+        if (0 != copies % period) return best(pair, entry);
+        // the exploring copy takes the methods in turn
+        for (auto step = ::std::size_t{1}; step < Method::Count; ++step) {
+            auto const method = (copies / period + step) % Method::Count;
+            if (! pair.unusable[method]) return static_cast<Method>(method);
+        }
+        return best(pair, entry);
+    }
+
+    inline auto Table::record(Device source, Device destination, ::std::uint64_t size, Method method, Method used, ::std::uint64_t nanoseconds) noexcept(false) {
+        auto const lock = utils::makeUniqueLock(mMutex); utils::unused(lock);
+        auto &pair = mPairs[Key{source, destination}];
+        // a method the kernel refused for this pair of filesystems is not tried again
+        if (method != used) pair.unusable[method] = true;
+        if ((0 == size) || (0 == nanoseconds)) return;
+        auto &cell = pair.sizes[classOf(size)].cells[used];
+        auto const rate = static_cast<double>(size) / static_cast<double>(nanoseconds);
+        cell.rate = (0 == cell.samples) ? rate : cell.rate + (rate - cell.rate) / +8.0e+0;
+        ++cell.samples;
+    }
+
+    inline auto Table::describe() noexcept(false) {
+        auto &&result = ::std::vector<::std::string>{};
+        auto const lock = utils::makeUniqueLock(mMutex); utils::unused(lock);
+        for (auto const &item : mPairs) {
+            auto &&line = ::std::to_string(item.first.first) + " " + ::std::to_string(item.first.second);
+            for (auto const &entry : item.second.sizes) line.append(" ").append(label(best(item.second, entry)));
+            result.push_back(::std::move(line));
+        }
+        return ::std::move(result);
+    }
+
+} // namespace strategy
+} // namespace pure_cxx_posix
+
+#else
+#error "__cplusplus not defined. c++14 or hight is required"
+#endif // defined(__cplusplus) && (201402L <= __cplusplus)
+#endif // PURE_CXX_POSIX_STRATEGY_HPP
@@ -0,0 +1,88 @@
+#ifndef PURE_CXX_POSIX_STREAM_HPP
+#define PURE_CXX_POSIX_STREAM_HPP
+#pragma once
+#if defined(__cplusplus) && (201402L <= __cplusplus)
+
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+
+#include <string>
+#include <utility>
+#include <system_error>
+
+#include <unistd.h>
+#include <sys/un.h>
+#include <sys/time.h>
+#include <sys/socket.h>
+
+#include "descriptor.hpp"
+
+
+namespace pure_cxx_posix {
+namespace stream {
+
+    // a destination written as "unix:/path" is a stream socket instead of a directory
+    constexpr static char const prefix[] = "unix:";
+
+    // every file goes as a header, the relative name and exactly size bytes of data,
+    // the consumer answers with one status byte, zero meaning the file is committed on its side
+    struct Header final {
+        constexpr static ::std::uint32_t const signature = 0x46584350; // "PCXF"
+        constexpr static ::std::uint32_t const revision = 1;
+
+        ::std::uint32_t magic = signature, version = revision;
+        ::std::uint64_t size = 0, checksum = 0;
+        ::std::uint32_t length = 0, reserved = 0;
+    };
+
+    enum Acknowledgement : unsigned char { Committed = 0, Corrupted = 1, Failed = 2 };
+
+    template <class T> inline static auto remote(T const &destination) noexcept(true) {
+        return 0 == destination.compare(0, sizeof(prefix) - 1, prefix);
+    }
+
+    template <class T> inline static auto address(T const &destination) noexcept(false) {
+        return ::std::string{destination}.substr(sizeof(prefix) - 1);
+    }
+
+    inline static auto connect(::std::string const &path, ::std::error_code &code, double timeout) noexcept(true) {
+        auto &&address = ::sockaddr_un{}; address.sun_family = AF_UNIX;
+        if (! (path.size() < sizeof(address.sun_path))) { code = ::std::make_error_code(::std::errc::filename_too_long); return Descriptor{}; }
+        ::std::memcpy(address.sun_path, path.c_str(), path.size() + 1);
+        auto &&descriptor = Descriptor{::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0)};
+        if (! descriptor) { code.assign(errno, ::std::generic_category()); return Descriptor{}; }
+        auto const interval = ::timeval{static_cast<::time_t>(timeout), static_cast<::suseconds_t>((timeout - static_cast<::time_t>(timeout)) * 1.0e+6)};
+        ::setsockopt(descriptor.get(), SOL_SOCKET, SO_RCVTIMEO, &interval, sizeof(interval));
+        ::setsockopt(descriptor.get(), SOL_SOCKET, SO_SNDTIMEO, &interval, sizeof(interval));
+        if (0 != ::connect(descriptor.get(), reinterpret_cast<::sockaddr const *>(&address), sizeof(address))) { code.assign(errno, ::std::generic_category()); return Descriptor{}; }
+        return ::std::move(descriptor);
+    }
+
+    // whole buffer or an errno, a closed peer reads as EPIPE
+    inline static auto write(int descriptor, void const *data, ::std::size_t size) noexcept(true) {
+        for (auto const *bytes = static_cast<char const *>(data); 0 < size;) {
+            auto const count = ::send(descriptor, bytes, size, MSG_NOSIGNAL);
+            if (0 > count) { if (EINTR == errno) continue; return errno; }
+            bytes += count; size -= static_cast<::std::size_t>(count);
+        }
+        return 0;
+    }
+
+    inline static auto read(int descriptor, void *data, ::std::size_t size) noexcept(true) {
+        for (auto *bytes = static_cast<char *>(data); 0 < size;) {
+            auto const count = ::recv(descriptor, bytes, size, 0);
+            if (0 == count) return EPIPE;
+            if (0 > count) { if (EINTR == errno) continue; return errno; }
+            bytes += count; size -= static_cast<::std::size_t>(count);
+        }
+        return 0;
+    }
+
+} // namespace stream
+} // namespace pure_cxx_posix
+
+#else
+#error "__cplusplus not defined. c++14 or hight is required"
+#endif // defined(__cplusplus) && (201402L <= __cplusplus)
+#endif // PURE_CXX_POSIX_STREAM_HPP
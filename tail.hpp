@@ -0,0 +1,234 @@
+#ifndef PURE_CXX_POSIX_TAIL_HPP
+#define PURE_CXX_POSIX_TAIL_HPP
+#pragma once
+#if defined(__cplusplus) && (201402L <= __cplusplus)
+
+#include <cerrno>
+#include <cstdint>
+#include <cstdio>
+
+#include <map>
+#include <set>
+#include <string>
+#include <utility>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <unordered_map>
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#include "probe.hpp"
+#include "engine.hpp"
+#include "backlog.hpp"
+#include "checksum.hpp"
+#include "logger.hpp"
+#include "context.hpp"
+#include "exception.hpp"
+#include "descriptor.hpp"
+#include "utils.hpp"
+#include "stdfs.hpp"
+
+
+namespace pure_cxx_posix {
+namespace tail {
+
+    using Key = ::std::pair<::std::uint64_t, ::std::uint64_t>; // device, inode
+
+    // how far a source inode has been shipped and which destination file receives it
+    struct Entry final {
+        ::std::uint64_t offset = 0;
+        ::std::int64_t mtime = 0;
+        // checksum of the first bytes shipped: a file truncated and rewritten past its old offset
+        // between two scans keeps growing in size, but not its head
+        checksum::Value head = checksum::initial;
+        ::std::uint32_t length = 0;
+        ::std::string name;
+    };
+
+    constexpr static ::std::uint32_t const head = 256;
+
+    inline static auto fingerprint(int descriptor, ::std::uint32_t length) noexcept(true) {
+        char buffer[head];
+        if (static_cast<::ssize_t>(length) != ::pread(descriptor, buffer, length, 0)) return ~checksum::initial;
+        return checksum::make(buffer, length);
+    }
+
+    inline static ::std::string path() noexcept(false) {
+        auto const &&name = utils::copy(Context::instance().name);
+        return stdfs::absolute((name.empty() ? ::std::string{utils::defaultName()} : ::std::move(name)) + ".tail", "/var/lib");
+    }
+
+    // growing files are mirrored into the destination by appending what was written since
+    // the previous scan; a new inode under a known name is a rotation, the previous generation
+    // is renamed to "name.<inode>" in the destination, and a shrunk file is a truncation
+    // that restarts its destination from zero
+    struct Type final {
+        struct Result final { ::std::size_t shipped = 0, failed = 0; ::std::uint64_t bytes = 0; bool complete = true; };
+
+        template <class srcT, class dstT, class stopT> inline auto ship(srcT const &src, dstT const &dst, Backlog const &names, stopT &&stopped) noexcept(false);
+
+        // the offsets file is read on the first scan and rewritten after every scan that changed it
+        inline auto open(::std::string const &path) noexcept(false);
+
+    private:
+        ::std::string mPath;
+        bool mLoaded = false;
+        ::std::map<Key, Entry> mEntries;
+
+        inline auto load() noexcept(false);
+        inline auto save() const noexcept(false);
+    };
+
+    // one entry per line: device inode offset mtime head length size:name
+    inline auto Type::load() noexcept(false) {
+        auto stream = ::std::ifstream{mPath};
+        if (! stream) return;
+        auto &&line = ::std::string{};
+        while (::std::getline(stream, line)) {
+            auto &&parser = ::std::istringstream{line};
+            auto &&key = Key{}; auto &&entry = Entry{}; auto length = ::std::size_t{0}; auto separator = char{0};
+            if (! (parser >> key.first >> key.second >> entry.offset >> entry.mtime >> entry.head >> entry.length >> length >> separator) || (':' != separator)) continue;
+            entry.name.resize(length);
+            if (! parser.read(&entry.name[0], static_cast<::std::streamsize>(length))) continue;
+            mEntries[key] = ::std::move(entry);
+        }
+        Logger::instance() << "Tail offsets loaded for " << mEntries.size() << " files from " << mPath;
+    }
+
+    // the offsets reach the disk before the rename and the rename before the next scan, a crash
+    // leaves either the previous offsets or the new ones
+    inline auto Type::save() const noexcept(false) {
+        auto const temporary = mPath + ".new";
+        auto &&stream = ::std::ostringstream{};
+        for (auto const &item : mEntries) {
+            auto const &entry = item.second;
+            stream << item.first.first << ' ' << item.first.second << ' ' << entry.offset << ' ' << entry.mtime << ' ' << entry.head << ' ' << entry.length << ' ' << entry.name.size() << ':' << entry.name << '\n';
+        }
+        auto const content = stream.str();
+        {
+            auto const out = Descriptor{::open(temporary.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644)};
+            auto done = ::std::size_t{0};
+            while (out && (done < content.size())) {
+                auto const count = ::write(out.get(), content.data() + done, content.size() - done);
+                if ((0 > count) && (EINTR == errno)) continue;
+                if (0 > count) break;
+                done += static_cast<::std::size_t>(count);
+            }
+            if ((! out) || (done < content.size()) || (0 != ::fsync(out.get()))) throw PURE_CXX_POSIX_EXCEPTION_MAKE(::std::runtime_error{
+                "failed to write tail offsets " + temporary + ": " + utils::errorCodeToString()
+            });
+        }
+        if (0 != ::rename(temporary.c_str(), mPath.c_str())) throw PURE_CXX_POSIX_EXCEPTION_MAKE(::std::runtime_error{
+            "failed to rename tail offsets " + temporary + ": " + utils::errorCodeToString()
+        });
+        auto const parent = stdfs::path{mPath}.parent_path();
+        auto const directory = Descriptor{::open(parent.empty() ? "." : parent.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC)};
+        if ((! directory) || (0 != ::fsync(directory.get()))) throw PURE_CXX_POSIX_EXCEPTION_MAKE(::std::runtime_error{
+            "failed to fsync tail offsets directory: " + utils::errorCodeToString()
+        });
+    }
+
+    inline auto Type::open(::std::string const &path) noexcept(false) {
+        if (mLoaded && (path == mPath)) return;
+        mPath = path; mEntries.clear(); mLoaded = true;
+        load();
+    }
+
+    template <class srcT, class dstT, class stopT> inline auto Type::ship(srcT const &src, dstT const &dst, Backlog const &names, stopT &&stopped) noexcept(false) {
+        auto const srcDirectory = Descriptor{::open(stdfs::path{src}.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC)};
+        if (! srcDirectory) throw PURE_CXX_POSIX_EXCEPTION_MAKE(::std::runtime_error{"failed to open source directory: " + utils::errorCodeToString()});
+        auto const dstDirectory = Descriptor{::open(stdfs::path{dst}.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC)};
+        if (! dstDirectory) throw PURE_CXX_POSIX_EXCEPTION_MAKE(::std::runtime_error{"failed to open destination directory: " + utils::errorCodeToString()});
+
+        auto &&result = Result{};
+        auto changed = false;
+        ::std::set<Key> seen;
+        ::std::unordered_map<::std::string, Key> owners;
+        for (auto const &item : mEntries) owners[item.second.name] = item.first;
+
+        for (auto index = ::std::size_t{0}; index < names.size(); ++index) {
+            if (stopped()) { result.complete = false; break; }
+            auto const name = names[index].str();
+            auto const in = Descriptor{::openat(srcDirectory.get(), name.c_str(), O_RDONLY | O_CLOEXEC | O_NOFOLLOW)};
+            struct ::stat information;
+            if ((! in) || (0 != ::fstat(in.get(), &information)) || (! S_ISREG(information.st_mode))) continue;
+            auto const key = Key{information.st_dev, information.st_ino};
+            auto const size = static_cast<::std::uint64_t>(information.st_size);
+            auto const mtime = ::std::int64_t{information.st_mtim.tv_sec} * 1000000000 + information.st_mtim.tv_nsec;
+            seen.insert(key);
+
+            auto iterator = mEntries.find(key);
+            if (mEntries.end() == iterator) {
+                auto const owner = owners.find(name);
+                if ((owners.end() != owner) && (0 < mEntries.count(owner->second))) {
+                    auto const generation = owner->second;
+                    auto &previous = mEntries[generation];
+                    auto &&renamed = name + "." + ::std::to_string(generation.second);
+                    Logger::instance() << "Rotation of " << name << " detected, previous generation is " << renamed << " now";
+                    if ((0 != ::renameat(dstDirectory.get(), name.c_str(), dstDirectory.get(), renamed.c_str())) && (ENOENT != errno)) {
+                        Logger::instance<Logger::Category::Error>() << "Failed to rename " << name << " to " << renamed << ": " << utils::errorCodeToString();
+                    }
+                    previous.name = ::std::move(renamed);
+                    owners[previous.name] = generation;
+                }
+                auto &&entry = Entry{}; entry.name = name;
+                iterator = mEntries.emplace(key, ::std::move(entry)).first;
+                owners[name] = key;
+                changed = true;
+            }
+
+            auto &entry = iterator->second;
+            if ((size == entry.offset) && (mtime == entry.mtime)) continue;
+            // the entry keeps its offset until the destination is truncated too, a failure is detected again next scan
+            auto const truncated = (size < entry.offset) || ((0 < entry.length) && (entry.head != fingerprint(in.get(), entry.length)));
+            if (truncated) Logger::instance() << "Truncation of " << name << " detected, shipping it from the beginning";
+            else if (size == entry.offset) { entry.mtime = mtime; changed = true; continue; }
+            auto const offset = truncated ? ::std::uint64_t{0} : entry.offset;
+
+            auto const slash = entry.name.rfind('/');
+            if (::std::string::npos != slash) {
+                auto &&code = ::std::error_code{};
+                stdfs::create_directories(stdfs::path{dst} / entry.name.substr(0, slash), code);
+            }
+            auto const out = Descriptor{::openat(dstDirectory.get(), entry.name.c_str(), O_WRONLY | O_CREAT | O_CLOEXEC | (truncated ? O_TRUNC : 0), 0644)};
+            auto const status = (! out) ? engine::Status::failure(errno, "openat")
+                : (offset < size) ? engine::append(in.get(), out.get(), static_cast<::off_t>(offset), static_cast<::off_t>(size)) : engine::Status::success();
+            if (status.failed()) {
+                ++result.failed;
+                Logger::instance<Logger::Category::Error>() << "Failed to ship " << name << " from offset " << offset << ": " << status.operation << ": " << status.code.message();
+                continue;
+            }
+            if (truncated) entry.length = 0;
+            if (offset < size) {
+                PURE_CXX_POSIX_PROBE(append__done, name.c_str(), offset, size);
+                result.bytes += size - offset; ++result.shipped;
+            }
+            entry.offset = size; entry.mtime = mtime; changed = true;
+            if (entry.length < head) {
+                entry.length = static_cast<::std::uint32_t>(size < head ? size : head);
+                entry.head = fingerprint(in.get(), entry.length);
+            }
+        }
+
+        // vanished inodes are forgotten only after a full pass, an interrupted one didn't see them all
+        if (result.complete) for (auto iterator = mEntries.begin(); mEntries.end() != iterator;) {
+            if (0 < seen.count(iterator->first)) { ++iterator; continue; }
+            iterator = mEntries.erase(iterator); changed = true;
+        }
+        if (changed) save();
+        return result;
+    }
+
+} // namespace tail
+
+    using Tail = tail::Type;
+
+} // namespace pure_cxx_posix
+
+#else
+#error "__cplusplus not defined. c++14 or hight is required"
+#endif // defined(__cplusplus) && (201402L <= __cplusplus)
+#endif // PURE_CXX_POSIX_TAIL_HPP
@@ -0,0 +1,73 @@
+#if defined(__cplusplus) && 201402L <= __cplusplus
+
+#include <cstdlib>
+#include <cstdint>
+
+#include <chrono>
+#include <string>
+#include <iostream>
+
+#include "../mover.hpp"
+#include "../backend.hpp"
+#include "../backlog.hpp"
+#include "../config.hpp"
+#include "../logger.hpp"
+#include "../storm.hpp"
+#include "../retry.hpp"
+
+
+// runs the mover of the daemon over the in-memory backend: scheduling, batching, retries and
+// storm handling without a disk underneath, so its own overhead shows in files per second
+namespace pure_cxx_posix {
+namespace bench {
+
+    inline static auto main(int argc, char **argv) noexcept(false) {
+        if ((3 > argc) || (5 < argc)) {
+            ::std::cerr << "usage: pcxxpd-bench <files> <threads> [latency-us] [failure-rate]" << ::std::endl;
+            return EXIT_FAILURE;
+        }
+        auto const files = ::std::stoul(argv[1]);
+        auto &&config = Config{};
+        config.src = "memory"; config.dst = "memory";
+        config.threads = ::std::stoi(argv[2]);
+        if ((1 > config.threads) || (256 < config.threads)) { ::std::cerr << "invalid threads" << ::std::endl; return EXIT_FAILURE; }
+        // injected failures are spread over the files, a streak of them is not an error storm here
+        config.storm.threshold = 0;
+        auto &&faults = backend::Memory::Faults{};
+        if (3 < argc) faults.latency = ::std::stod(argv[3]) * +1.0e-6;
+        if (4 < argc) faults.rate = ::std::stod(argv[4]);
+
+        // a log line per file would be what is measured
+        Logger::instance<Logger::Category::Info>().sink = {};
+        Logger::instance<Logger::Category::Error>().sink = {};
+
+        auto &&backend = backend::Memory{faults, static_cast<::std::size_t>(config.threads)};
+        auto &&names = Backlog{};
+        for (auto index = ::std::size_t{0}; index < files; ++index) {
+            auto const name = "d" + ::std::to_string(index % 64) + "/f" + ::std::to_string(index);
+            backend.add(name, 4096); names.push(name);
+        }
+
+        auto &&storm = Storm{};
+        auto &&retries = Retry{};
+        auto const start = ::std::chrono::steady_clock::now();
+        auto const result = mover::run(backend, storm, retries, config, ::std::move(names), false);
+        auto const seconds = ::std::chrono::duration<double>{::std::chrono::steady_clock::now() - start}.count();
+
+        ::std::cout << "files " << files << ", threads " << config.threads << ", moved " << result.moved << ", failed " << result.failed
+                    << ", deferred " << result.deferred << ", retrying " << retries.size() << ::std::endl;
+        ::std::cout << seconds << " s, " << static_cast<::std::uint64_t>(static_cast<double>(files) / seconds) << " files/s" << ::std::endl;
+        return (backend.committed() == result.moved) ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+
+} // namespace bench
+} // namespace pure_cxx_posix
+
+int main(int argc, char **argv) {
+    try { return ::pure_cxx_posix::bench::main(argc, argv); } catch(...) {}
+    return EXIT_FAILURE;
+}
+
+#else
+#error "__cplusplus not defined. c++14 or hight is required"
+#endif // defined(__cplusplus) && 201402L <= __cplusplus
@@ -0,0 +1,142 @@
+#if defined(__cplusplus) && 201402L <= __cplusplus
+
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+
+#include <string>
+#include <thread>
+#include <utility>
+#include <iostream>
+#include <system_error>
+
+#include <fcntl.h>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/un.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/socket.h>
+
+#include "../stream.hpp"
+#include "../checksum.hpp"
+#include "../descriptor.hpp"
+#include "../stdfs.hpp"
+
+
+// reference consumer of a "unix:" destination: every file is spliced from the socket into
+// a temporary file, checked against the header checksum, synced, renamed and acknowledged
+namespace pure_cxx_posix {
+namespace receiver {
+
+    inline static auto fail(::std::string const &what, int code = errno) noexcept(false) {
+        ::std::cerr << "pcxxpd-receiver: " << what << ": " << ::std::strerror(code) << ::std::endl;
+    }
+
+    // relative, without empty, "." or ".." components
+    inline static auto valid(::std::string const &name) noexcept(true) {
+        if (name.empty() || ('/' == name.front()) || ('/' == name.back())) return false;
+        for (::std::size_t begin = 0, end = 0; begin < name.size(); begin = end + 1) {
+            end = name.find('/', begin); if (::std::string::npos == end) end = name.size();
+            auto const component = name.substr(begin, end - begin);
+            if (component.empty() || ("." == component) || (".." == component)) return false;
+        }
+        return true;
+    }
+
+    // socket -> pipe -> file without copying through user space
+    inline static auto splice(int socket, int file, ::std::uint64_t size) noexcept(true) {
+        int pipe[2];
+        if (0 != ::pipe2(pipe, O_CLOEXEC)) return errno;
+        auto const in = Descriptor{pipe[0]}, out = Descriptor{pipe[1]};
+        while (0 < size) {
+            auto const chunk = static_cast<::std::size_t>(size < (1u << 20) ? size : (1u << 20));
+            auto const received = ::splice(socket, nullptr, out.get(), nullptr, chunk, SPLICE_F_MOVE | SPLICE_F_MORE);
+            if (0 == received) return EPIPE;
+            if (0 > received) { if (EINTR == errno) continue; return errno; }
+            for (auto left = received; 0 < left;) {
+                auto const written = ::splice(in.get(), nullptr, file, nullptr, static_cast<::std::size_t>(left), SPLICE_F_MOVE | SPLICE_F_MORE);
+                if (0 >= written) { if ((0 > written) && (EINTR == errno)) continue; return (0 == written) ? EIO : errno; }
+                left -= written;
+            }
+            size -= static_cast<::std::uint64_t>(received);
+        }
+        return 0;
+    }
+
+    inline static auto verify(int file, ::std::uint64_t size, checksum::Value expected) noexcept(true) {
+        if (0 == size) return checksum::initial == expected;
+        auto const map = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, file, 0);
+        if (MAP_FAILED == map) return false;
+        auto const value = checksum::make(map, size);
+        ::munmap(map, size);
+        return value == expected;
+    }
+
+    inline static auto serve(Descriptor connection, stdfs::path const root) noexcept(true) {
+        while (true) try {
+            auto &&header = stream::Header{};
+            if (stream::read(connection.get(), &header, sizeof(header))) return;
+            if ((stream::Header::signature != header.magic) || (stream::Header::revision != header.version) || (4096 < header.length)) return fail("bad header", EPROTO);
+            auto &&name = ::std::string(header.length, '\0');
+            if (auto const code = stream::read(connection.get(), &name[0], name.size())) return fail("name", code);
+            if (! valid(name)) return fail("bad name " + name, EPROTO);
+
+            auto const target = root / name;
+            auto const temporary = target.parent_path() / ("." + target.filename().native() + ".part");
+            auto &&code = ::std::error_code{};
+            stdfs::create_directories(target.parent_path(), code);
+            auto const file = Descriptor{::open(temporary.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644)};
+            // the data is on the wire anyway, it has to be drained to keep the stream in sync
+            if (! file) {
+                fail("open " + temporary.native());
+                auto const sink = Descriptor{::open("/dev/null", O_WRONLY | O_CLOEXEC)};
+                if (splice(connection.get(), sink.get(), header.size)) return;
+                auto const acknowledgement = static_cast<unsigned char>(stream::Failed);
+                if (stream::write(connection.get(), &acknowledgement, 1)) return;
+                continue;
+            }
+            if (auto const error = splice(connection.get(), file.get(), header.size)) { ::unlink(temporary.c_str()); return fail("receive " + name, error); }
+
+            auto acknowledgement = static_cast<unsigned char>(stream::Committed);
+            if (! verify(file.get(), header.size, header.checksum)) acknowledgement = stream::Corrupted;
+            else if ((0 != ::fdatasync(file.get())) || (0 != ::rename(temporary.c_str(), target.c_str()))) { fail("commit " + name); acknowledgement = stream::Failed; }
+            if (stream::Committed != acknowledgement) ::unlink(temporary.c_str());
+            else ::std::cout << target.native() << " " << header.size << ::std::endl;
+            if (stream::write(connection.get(), &acknowledgement, 1)) return;
+        } catch(...) { return fail("unexpected exception", EIO); }
+    }
+
+    inline static auto main(int argc, char **argv) noexcept(false) {
+        if (3 != argc) { ::std::cerr << "usage: pcxxpd-receiver <socket> <directory>" << ::std::endl; return EXIT_FAILURE; }
+        ::signal(SIGPIPE, SIG_IGN);
+        auto const path = ::std::string{argv[1]};
+        auto const root = stdfs::path{argv[2]};
+
+        auto &&address = ::sockaddr_un{}; address.sun_family = AF_UNIX;
+        if (! (path.size() < sizeof(address.sun_path))) { fail(path, ENAMETOOLONG); return EXIT_FAILURE; }
+        ::std::memcpy(address.sun_path, path.c_str(), path.size() + 1);
+        auto const listener = Descriptor{::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0)};
+        ::unlink(path.c_str());
+        if ((! listener) || (0 != ::bind(listener.get(), reinterpret_cast<::sockaddr const *>(&address), sizeof(address))) || (0 != ::listen(listener.get(), 64))) {
+            fail("listen " + path); return EXIT_FAILURE;
+        }
+
+        while (true) {
+            auto &&connection = Descriptor{::accept4(listener.get(), nullptr, nullptr, SOCK_CLOEXEC)};
+            if (! connection) { if (EINTR != errno) fail("accept"); continue; }
+            ::std::thread{[root] (Descriptor connection) { serve(::std::move(connection), root); }, ::std::move(connection)}.detach();
+        }
+    }
+
+} // namespace receiver
+} // namespace pure_cxx_posix
+
+int main(int argc, char **argv) {
+    try { return ::pure_cxx_posix::receiver::main(argc, argv); } catch(...) {}
+    return EXIT_FAILURE;
+}
+
+#else
+#error "__cplusplus not defined. c++14 or hight is required"
+#endif // defined(__cplusplus) && 201402L <= __cplusplus
@@ -0,0 +1,75 @@
+#if defined(__cplusplus) && 201402L <= __cplusplus
+
+#include <cerrno>
+#include <cstdlib>
+#include <cstdint>
+
+#include <string>
+#include <iostream>
+#include <system_error>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "../segment.hpp"
+#include "../descriptor.hpp"
+#include "../stdfs.hpp"
+
+
+// lists the files of a sealed segment with their sizes and whether their checksums match,
+// or extracts them under a directory; the reader is what consumers of segments link with
+namespace pure_cxx_posix {
+namespace unpack {
+
+    inline static auto extract(segment::View const &view, stdfs::path const &directory) noexcept(false) {
+        // names come from the segment, they must not leave the directory
+        auto const key = view.key();
+        errno = 0;
+        if (key.empty() || ('/' == key.front()) || (::std::string::npos != ("/" + key + "/").find("/../"))) return false;
+        auto const target = directory / key;
+        auto &&code = ::std::error_code{};
+        stdfs::create_directories(target.parent_path(), code);
+        auto const out = Descriptor{::open(target.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644)};
+        if (! out) return false;
+        for (auto done = ::std::uint64_t{0}; done < view.size;) {
+            auto const count = ::write(out.get(), view.data + done, static_cast<::std::size_t>(view.size - done));
+            if ((0 > count) && (EINTR == errno)) continue;
+            if (0 > count) return false;
+            done += static_cast<::std::uint64_t>(count);
+        }
+        return true;
+    }
+
+    inline static auto main(int argc, char **argv) noexcept(false) {
+        if ((2 > argc) || (3 < argc)) {
+            ::std::cerr << "usage: pcxxpd-unpack <segment> [directory]" << ::std::endl;
+            return EXIT_FAILURE;
+        }
+        auto &&reader = segment::Reader{};
+        auto &&code = ::std::error_code{};
+        if (! reader.open(argv[1], code)) { ::std::cerr << argv[1] << ": " << code.message() << ::std::endl; return EXIT_FAILURE; }
+        auto result = EXIT_SUCCESS;
+        for (auto index = ::std::size_t{0}; index < reader.size(); ++index) {
+            auto const view = reader[index];
+            auto const valid = view.verify();
+            if (! valid) result = EXIT_FAILURE;
+            if (2 == argc) { ::std::cout << view.size << " " << (valid ? "ok" : "corrupt") << " " << view.key() << ::std::endl; continue; }
+            if (! valid) { ::std::cerr << view.key() << ": checksum mismatch, skipped" << ::std::endl; continue; }
+            if (extract(view, argv[2])) continue;
+            ::std::cerr << view.key() << ": " << ((0 == errno) ? "invalid name" : ::std::error_code{errno, ::std::generic_category()}.message()) << ::std::endl;
+            result = EXIT_FAILURE;
+        }
+        return result;
+    }
+
+} // namespace unpack
+} // namespace pure_cxx_posix
+
+int main(int argc, char **argv) {
+    try { return ::pure_cxx_posix::unpack::main(argc, argv); } catch(...) {}
+    return EXIT_FAILURE;
+}
+
+#else
+#error "__cplusplus not defined. c++14 or hight is required"
+#endif // defined(__cplusplus) && 201402L <= __cplusplus
@@ -0,0 +1,163 @@
+#ifndef PURE_CXX_POSIX_WALK_HPP
+#define PURE_CXX_POSIX_WALK_HPP
+#pragma once
+#if defined(__cplusplus) && (201402L <= __cplusplus)
+
+#include <cstring>
+
+#include <mutex>
+#include <atomic>
+#include <string>
+#include <vector>
+#include <utility>
+#include <iterator>
+#include <algorithm>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <dirent.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#include "pool.hpp"
+#include "backlog.hpp"
+#include "logger.hpp"
+#include "exception.hpp"
+#include "descriptor.hpp"
+#include "utils.hpp"
+
+
+namespace pure_cxx_posix {
+namespace walk {
+
+    using Names = ::std::vector<::std::string>;
+
+    struct Result final {
+        Backlog files;      // regular files relative to the root
+        Names directories;  // subdirectories that had entries, deepest first
+        bool truncated = false;
+    };
+
+    // deepest first, so that a parent is removed after its children; each directory once, the walks
+    // of the batches of one scan list the same ones
+    inline static auto deepest(Names &directories) noexcept(false) {
+        auto const depth = [] (auto const &path) { return ::std::count(path.begin(), path.end(), '/'); };
+        ::std::sort(directories.begin(), directories.end(), [&depth] (auto const &a, auto const &b) {
+            auto const x = depth(a), y = depth(b);
+            return (x != y) ? (x > y) : (a < b);
+        });
+        directories.erase(::std::unique(directories.begin(), directories.end()), directories.end());
+    }
+
+    // recursive listing of root, subdirectories are spread over the threads of the pool; symbolic links
+    // to regular files are listed like in a flat listing, links to directories are never descended into;
+    // the listing stops once the files took limit bytes (0 is no limit) and is truncated then
+    template <class T, class acceptT, class prepareT> inline static auto tree(T const &root, ::std::size_t threads, acceptT &&accept, prepareT &&prepare, ::std::size_t limit = 0) noexcept(false) {
+        auto const descriptor = Descriptor{::open(root.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC)};
+        if (! descriptor) throw PURE_CXX_POSIX_EXCEPTION_MAKE(::std::runtime_error{"failed to open source directory: " + utils::errorCodeToString()});
+
+        auto &&pool = Pool<::std::string>{threads};
+        ::std::vector<Result> partial(threads < 1 ? 1 : threads);
+        ::std::atomic<::std::size_t> used{0};
+        ::std::atomic<bool> truncated{false};
+
+        pool.run({::std::string{}}, [&descriptor, &partial, &accept, &used, &truncated, limit] (auto index, auto &&relative, auto const &push) {
+            if (truncated.load(::std::memory_order_relaxed)) return;
+            auto &result = partial[index];
+            auto const fd = relative.empty() ? ::dup(descriptor.get()) : ::openat(descriptor.get(), relative.c_str(), O_RDONLY | O_DIRECTORY | O_NOFOLLOW | O_CLOEXEC);
+            if (0 > fd) { Logger::instance<Logger::Category::Error>() << "Failed to open source subdirectory " << relative << ": " << utils::errorCodeToString(); return; }
+            auto const directory = ::fdopendir(fd);
+            if (nullptr == directory) { ::close(fd); Logger::instance<Logger::Category::Error>() << "Failed to list source subdirectory " << relative << ": " << utils::errorCodeToString(); return; }
+            if (! relative.empty()) relative.push_back('/');
+            auto populated = false;
+            try {
+                while (auto const entry = ::readdir(directory)) {
+                    if ((0 == ::std::strcmp(entry->d_name, ".")) || (0 == ::std::strcmp(entry->d_name, ".."))) continue;
+                    populated = true;
+                    auto type = entry->d_type;
+                    struct ::stat information;
+                    if (DT_UNKNOWN == type) {
+                        if (0 != ::fstatat(::dirfd(directory), entry->d_name, &information, AT_SYMLINK_NOFOLLOW)) continue;
+                        type = S_ISDIR(information.st_mode) ? DT_DIR : S_ISREG(information.st_mode) ? DT_REG : S_ISLNK(information.st_mode) ? DT_LNK : DT_UNKNOWN;
+                    }
+                    if (DT_LNK == type) {
+                        if (0 != ::fstatat(::dirfd(directory), entry->d_name, &information, 0)) continue;
+                        type = S_ISREG(information.st_mode) ? DT_REG : DT_UNKNOWN;
+                    }
+                    if (DT_DIR == type) push(relative + entry->d_name);
+                    else if (DT_REG == type) {
+                        auto &&name = relative + entry->d_name;
+                        if (! accept(name)) continue;
+                        result.files.push(name);
+                        if ((0 < limit) && (limit < used.fetch_add(name.size() + 1 + sizeof(::std::uint32_t), ::std::memory_order_relaxed))) { truncated = true; break; }
+                    }
+                }
+            } catch(...) { ::closedir(directory); throw; }
+            ::closedir(directory);
+            if (populated && (! relative.empty())) { relative.pop_back(); result.directories.push_back(::std::move(relative)); }
+        }, ::std::forward<prepareT>(prepare));
+
+        auto &&result = Result{};
+        result.truncated = truncated;
+        for (auto &item : partial) {
+            result.files.append(::std::move(item.files));
+            result.directories.insert(result.directories.end(), ::std::make_move_iterator(item.directories.begin()), ::std::make_move_iterator(item.directories.end()));
+        }
+        deepest(result.directories);
+        return ::std::move(result);
+    }
+
+    // flat listing of a directory in batches: the stream stays open between batches, so a huge
+    // directory is never held in memory at once; symbolic links to regular files are listed
+    struct Listing final {
+        // appends accepted regular files until they took limit bytes (0 is no limit), false at the end of the directory
+        template <class acceptT> inline auto fill(Backlog &backlog, acceptT &&accept, ::std::size_t limit) noexcept(false) {
+            auto &&name = ::std::string{};
+            auto used = ::std::size_t{0};
+            while (auto const entry = ::readdir(mDirectory)) {
+                auto type = entry->d_type;
+                if ((DT_UNKNOWN == type) || (DT_LNK == type)) {
+                    struct ::stat information;
+                    if (0 != ::fstatat(::dirfd(mDirectory), entry->d_name, &information, 0)) continue;
+                    type = S_ISREG(information.st_mode) ? DT_REG : DT_UNKNOWN;
+                }
+                if (DT_REG != type) continue;
+                name.assign(entry->d_name);
+                if (! accept(name)) continue;
+                backlog.push(name);
+                used += name.size() + 1 + sizeof(::std::uint32_t);
+                if ((0 < limit) && (limit < used)) return true;
+            }
+            return false;
+        }
+
+        template <class T> inline explicit Listing(T const &root) noexcept(false) : mDirectory{::opendir(root.c_str())} {
+            if (nullptr == mDirectory) throw PURE_CXX_POSIX_EXCEPTION_MAKE(::std::runtime_error{"failed to open source directory: " + utils::errorCodeToString()});
+        }
+
+        inline ~Listing() noexcept(true) { if (nullptr != mDirectory) ::closedir(mDirectory); }
+
+        Listing(Listing &&) = delete;
+        Listing(Listing const &) = delete;
+        template <class U> Listing & operator = (U &&) = delete;
+
+    private:
+        ::DIR *mDirectory;
+    };
+
+    // removes the listed directories that are empty now, failures are expected and ignored
+    template <class T> inline static auto prune(T const &root, Names const &directories) noexcept(true) {
+        auto const descriptor = Descriptor{::open(root.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC)};
+        if (! descriptor) return ::std::size_t{0};
+        auto removed = ::std::size_t{0};
+        for (auto const &relative : directories) if (0 == ::unlinkat(descriptor.get(), relative.c_str(), AT_REMOVEDIR)) ++removed;
+        return removed;
+    }
+
+} // namespace walk
+} // namespace pure_cxx_posix
+
+#else
+#error "__cplusplus not defined. c++14 or hight is required"
+#endif // defined(__cplusplus) && (201402L <= __cplusplus)
+#endif // PURE_CXX_POSIX_WALK_HPP